@@ -0,0 +1,191 @@
+#ifndef L3_ARCCACHE_H
+#define L3_ARCCACHE_H
+
+#include "ICache.h"
+#include "Dictionary.h"
+#include "RecencyList.h"
+#include <iostream>
+#include <stdexcept>
+
+// Adaptive Replacement Cache (Megiddo, Modha).
+// T1 - элементы, к которым обратились один раз, T2 - хотя бы дважды.
+// B1 и B2 - "призрачные" списки ключей, недавно вытесненных из T1 и T2.
+// Попадание в B1 или B2 сдвигает целевой размер T1 (target) в пользу того списка,
+// который вытеснили зря, так что кэш сам подстраивается между LRU и LFU.
+// Однократный проход по ключам задевает только T1, горячие данные в T2 остаются
+template <typename Key, typename Value>
+class ARCCache : public ICache<Key, Value> {
+private:
+    enum ListId : unsigned char { T1, T2, B1, B2 };
+
+    struct Location {
+        ListId list = T1;
+        size_t index = 0;
+    };
+
+    using List = RecencyList<Key, Value>;
+
+    size_t capacity_;
+    size_t target; // Целевой размер T1 (p в оригинальной статье)
+    List t1, t2, b1, b2;
+    Dictionary<Key, Location> locations;
+
+    List& listOf(ListId id) {
+        switch (id) {
+            case T1: return t1;
+            case T2: return t2;
+            case B1: return b1;
+            default: return b2;
+        }
+    }
+
+    void drop(List& list) { // Полностью забывает самый старый ключ списка
+        size_t oldest = list.front();
+        locations.remove(list.key(oldest));
+        list.remove(oldest);
+    }
+
+    void demote(List& from, List& ghost, ListId ghostId) { // Переносит самый старый ключ в призрачный список
+        size_t oldest = from.front();
+        Key key = from.key(oldest);
+        from.remove(oldest);
+        locations[key] = {ghostId, ghost.pushBack(key, Value{})};
+    }
+
+    // Вытесняет один элемент из T1 или T2 в зависимости от target (REPLACE в статье)
+    void replace(bool hitInB2) {
+        if (t1.size() + t2.size() < capacity_) {
+            return;
+        }
+        if (!t1.empty() && (t1.size() > target || (hitInB2 && t1.size() == target) || t2.empty())) {
+            demote(t1, b1, B1);
+        } else {
+            demote(t2, b2, B2);
+        }
+    }
+
+    // Повторное обращение к элементу из T1 или T2 делает его самым новым в T2
+    void promote(const Key& key, const Location& location) {
+        if (location.list == T2) {
+            t2.moveToBack(location.index);
+            return;
+        }
+        Value value = std::move(t1.value(location.index));
+        t1.remove(location.index);
+        locations[key] = {T2, t2.pushBack(key, std::move(value))};
+    }
+
+    void promoteGhost(const Key& key, const Value& value, ListId ghostId) {
+        List& ghost = listOf(ghostId);
+        size_t b1Size = b1.size(), b2Size = b2.size();
+        if (ghostId == B1) {
+            size_t delta = b2Size > b1Size ? b2Size / b1Size : 1;
+            target = target + delta > capacity_ ? capacity_ : target + delta;
+        } else {
+            size_t delta = b1Size > b2Size ? b1Size / b2Size : 1;
+            target = target > delta ? target - delta : 0;
+        }
+        ghost.remove(locations.get(key).index);
+        locations.remove(key);
+        replace(ghostId == B2);
+        locations.add(key, {T2, t2.pushBack(key, value)});
+    }
+
+public:
+    explicit ARCCache(size_t capacity) : capacity_(capacity), target(0) {}
+
+    void access(const Key& key, const Value& value) override {
+        if (const Location* found = locations.find(key)) {
+            Location location = *found;
+            if (location.list == T1 || location.list == T2) {
+                List& list = listOf(location.list);
+                list.value(location.index) = value;
+                promote(key, location);
+                return;
+            }
+            promoteGhost(key, value, location.list);
+            return;
+        }
+        if (capacity_ == 0) {
+            return;
+        }
+        if (t1.size() + b1.size() >= capacity_) {
+            if (t1.size() < capacity_) {
+                drop(b1);
+                replace(false);
+            } else {
+                drop(t1);
+            }
+        } else if (t1.size() + t2.size() + b1.size() + b2.size() >= capacity_) {
+            if (t1.size() + t2.size() + b1.size() + b2.size() >= 2 * capacity_) {
+                drop(b2);
+            }
+            replace(false);
+        }
+        locations.add(key, {T1, t1.pushBack(key, value)});
+    }
+
+    bool contains(const Key& key) const override {
+        const Location* location = locations.find(key);
+        return location && (location->list == T1 || location->list == T2);
+    }
+
+    Value& get(const Key& key) override {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    const Value& get(const Key& key) const override {
+        const Location* location = locations.find(key);
+        if (!location || (location->list != T1 && location->list != T2)) {
+            throw std::runtime_error("Key not found");
+        }
+        return location->list == T1 ? t1.value(location->index) : t2.value(location->index);
+    }
+
+    Value* find(const Key& key) override {
+        Location* location = locations.find(key);
+        if (!location || (location->list != T1 && location->list != T2)) {
+            return nullptr;
+        }
+        if (location->list == T2) {
+            t2.moveToBack(location->index);
+            return &t2.value(location->index);
+        }
+        promote(key, Location(*location));
+        return &t2.value(t2.back());
+    }
+
+    size_t size() const override {
+        return t1.size() + t2.size();
+    }
+
+    void print() const override {
+        std::cout << "Cache contents (T1):\n";
+        for (size_t i = t1.front(); i != List::npos; i = t1.next(i)) {
+            std::cout << "Key: " << t1.key(i) << ", Value: " << t1.value(i) << "\n";
+        }
+        std::cout << "Cache contents (T2):\n";
+        for (size_t i = t2.front(); i != List::npos; i = t2.next(i)) {
+            std::cout << "Key: " << t2.key(i) << ", Value: " << t2.value(i) << "\n";
+        }
+    }
+
+    void clear() override {
+        t1.clear();
+        t2.clear();
+        b1.clear();
+        b2.clear();
+        locations.clear();
+        target = 0;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+};
+
+#endif //L3_ARCCACHE_H
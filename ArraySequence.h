@@ -79,25 +79,25 @@ public:
 
     //Функция, которая добавляет элемент в конец последовательности
     Sequence<T>* append(T value) override {
-        this->arrayList->append(value);
+        this->arrayList->append(std::move(value));
         return this;
     }
 
     //Функция, которая добавляет элемент в начало последовательности
     Sequence<T>* prepend(T value) override {
-        this->arrayList->prepend(value);
+        this->arrayList->prepend(std::move(value));
         return this;
     }
 
     //Функция, которая добавляет элемент в последовательность по индексу
     Sequence<T>* insertAt(T value, int index) override {
-        this->arrayList->insertAt(value, index);
+        this->arrayList->insertAt(std::move(value), index);
         return this;
     }
 
     //Функция, которая изменяет элемент в последовательности по индексу
     Sequence<T>* set(T value, int index) override {
-        this->arrayList->set(index, value);
+        this->arrayList->set(index, std::move(value));
         return this;
     }
 
@@ -0,0 +1,363 @@
+#ifndef L3_ASYNCREADER_H
+#define L3_ASYNCREADER_H
+
+#include "IAsyncReader.h"
+#include "ThreadPool.h"
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define L3_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// Запасная реализация: каждый запрос - pread на пуле потоков
+class ThreadPoolReader : public IAsyncReader {
+private:
+    struct Request {
+        int fd;
+        void* buffer;
+        size_t length;
+        uint64_t offset;
+        Completion done;
+        ssize_t result;
+        Request* next;
+    };
+
+    ThreadPool pool;
+    Request* queued; // Ещё не отправленные (в обратном порядке)
+    Request* completed; // Завершённые, обработчики ещё не вызваны
+    size_t pending; // Отправленные и не обработанные
+    std::mutex mutex;
+
+    static ssize_t readFully(int fd, void* buffer, size_t length, uint64_t offset) {
+        size_t filled = 0;
+        while (filled < length) {
+            ssize_t read = ::pread(fd, static_cast<char*>(buffer) + filled, length - filled,
+                                   static_cast<off_t>(offset + filled));
+            if (read < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -errno;
+            }
+            if (read == 0) {
+                break;
+            }
+            filled += static_cast<size_t>(read);
+        }
+        return static_cast<ssize_t>(filled);
+    }
+
+public:
+    explicit ThreadPoolReader(size_t threads = 8)
+        : pool(threads), queued(nullptr), completed(nullptr), pending(0) {}
+
+    ~ThreadPoolReader() override {
+        wait();
+    }
+
+    void read(int fd, void* buffer, size_t length, uint64_t offset, Completion done) override {
+        queued = new Request{fd, buffer, length, offset, std::move(done), 0, queued};
+        ++pending;
+    }
+
+    size_t submit() override {
+        size_t submitted = 0;
+        while (queued) {
+            Request* request = queued;
+            queued = request->next;
+            pool.submit([this, request] {
+                request->result = readFully(request->fd, request->buffer, request->length, request->offset);
+                std::lock_guard<std::mutex> lock(mutex);
+                request->next = completed;
+                completed = request;
+            });
+            ++submitted;
+        }
+        return submitted;
+    }
+
+    void wait() override {
+        while (pending != 0) {
+            submit();
+            pool.wait();
+            Request* ready;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready = completed;
+                completed = nullptr;
+            }
+            while (ready) { // Обработчик может поставить новые запросы - их подхватит следующий круг
+                Request* request = ready;
+                ready = request->next;
+                --pending;
+                Completion done = std::move(request->done);
+                ssize_t result = request->result;
+                delete request;
+                done(result);
+            }
+        }
+    }
+
+    size_t inFlight() const override {
+        return pending;
+    }
+
+    const char* name() const override {
+        return "thread pool";
+    }
+};
+
+#ifdef L3_HAS_IO_URING
+
+// Чтение через io_uring без liburing: кольца отображаются в память напрямую, запросы пишутся
+// в очередь отправки и уходят в ядро одним системным вызовом на пачку. Буферы можно
+// зарегистрировать заранее (registerBuffers) - тогда ядро не закрепляет страницы на каждый запрос
+class UringReader : public IAsyncReader {
+private:
+    // Запрос живёт от постановки в очередь до вызова обработчика. Короткое чтение
+    // дочитывается повторной отправкой остатка, как pread в цикле у ThreadPoolReader
+    struct Pending {
+        Completion done;
+        uint8_t opcode;
+        int fd;
+        char* buffer;
+        size_t length;
+        uint64_t offset;
+        uint16_t bufferIndex;
+        size_t filled; // Сколько уже прочитано
+    };
+
+    int ringFd;
+    unsigned entries;
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    io_uring_sqe* sqes;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+    size_t unsubmitted; // Записаны в очередь, но ядру ещё не переданы
+    size_t pending; // Переданы и не завершены (вместе с unsubmitted)
+
+    static int enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    template <typename T>
+    static T* at(void* base, unsigned offset) {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+    }
+
+    // Забирает готовые завершения, при minComplete > 0 сначала ждёт их
+    void reap(unsigned minComplete) {
+        if (minComplete != 0) {
+            while (enter(ringFd, 0, minComplete, IORING_ENTER_GETEVENTS) < 0) {
+                if (errno != EINTR) {
+                    throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+                }
+            }
+        }
+        unsigned head = *cqHead;
+        while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            io_uring_cqe& cqe = cqes[head & *cqMask];
+            Pending* finished = reinterpret_cast<Pending*>(static_cast<uintptr_t>(cqe.user_data));
+            int res = cqe.res;
+            __atomic_store_n(cqHead, ++head, __ATOMIC_RELEASE); // Ячейка свободна до вызова обработчика
+            --pending;
+            if (res > 0) {
+                finished->filled += static_cast<size_t>(res);
+                if (finished->filled < finished->length) { // Короткое чтение - дочитываем остаток
+                    enqueue(finished);
+                    head = *cqHead;
+                    continue;
+                }
+            }
+            ssize_t result = res < 0 ? res : static_cast<ssize_t>(finished->filled); // 0 - конец файла
+            Completion done = std::move(finished->done);
+            delete finished;
+            done(result);
+            head = *cqHead; // Обработчик мог забрать ещё завершения
+        }
+    }
+
+    // Записывает запрос в очередь отправки. Хвост очереди публикуется только после того,
+    // как ячейка заполнена целиком
+    void enqueue(Pending* request) {
+        while (pending >= entries) { // Завершений в полёте не больше, чем ячеек очереди
+            submit();
+            reap(1);
+        }
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = request->opcode;
+        sqe.fd = request->fd;
+        sqe.off = request->offset + request->filled;
+        sqe.addr = reinterpret_cast<uintptr_t>(request->buffer + request->filled);
+        sqe.len = static_cast<unsigned>(request->length - request->filled);
+        sqe.buf_index = request->bufferIndex;
+        sqe.user_data = reinterpret_cast<uintptr_t>(request);
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted;
+        ++pending;
+    }
+
+public:
+    // Проверяет, что io_uring доступен и ядро умеет IORING_OP_READ и IORING_OP_READ_FIXED.
+    // На ядрах 5.1-5.5 кольцо создаётся, но READ завершается с -EINVAL; там нет
+    // и IORING_REGISTER_PROBE, так что проверка тоже не проходит
+    static bool supported() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, 2, &params));
+        if (fd < 0) {
+            return false;
+        }
+        const unsigned opCount = 256;
+        size_t probeSize = sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op);
+        io_uring_probe* probe = static_cast<io_uring_probe*>(::operator new(probeSize));
+        std::memset(probe, 0, probeSize);
+        bool result = ::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, opCount) >= 0 &&
+                      probe->ops_len > IORING_OP_READ &&
+                      (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) &&
+                      (probe->ops[IORING_OP_READ_FIXED].flags & IO_URING_OP_SUPPORTED);
+        ::operator delete(probe);
+        ::close(fd);
+        return result;
+    }
+
+    explicit UringReader(unsigned queueDepth = 1024) : unsubmitted(0), pending(0) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, queueDepth, &params));
+        if (ringFd < 0) {
+            throw std::runtime_error(std::string("io_uring_setup failed: ") + std::strerror(errno));
+        }
+        entries = params.sq_entries;
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) {
+            sqRingSize = cqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+        }
+        sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        cqRing = singleMmap ? sqRing
+                 : ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        void* sqeMemory = ::mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqeMemory == MAP_FAILED) {
+            ::close(ringFd);
+            throw std::runtime_error("Cannot map io_uring rings");
+        }
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+        sqHead = at<unsigned>(sqRing, params.sq_off.head);
+        sqTail = at<unsigned>(sqRing, params.sq_off.tail);
+        sqMask = at<unsigned>(sqRing, params.sq_off.ring_mask);
+        sqArray = at<unsigned>(sqRing, params.sq_off.array);
+        cqHead = at<unsigned>(cqRing, params.cq_off.head);
+        cqTail = at<unsigned>(cqRing, params.cq_off.tail);
+        cqMask = at<unsigned>(cqRing, params.cq_off.ring_mask);
+        cqes = at<io_uring_cqe>(cqRing, params.cq_off.cqes);
+    }
+
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    ~UringReader() override {
+        wait();
+        ::munmap(sqes, entries * sizeof(io_uring_sqe));
+        if (cqRing != sqRing) {
+            ::munmap(cqRing, cqRingSize);
+        }
+        ::munmap(sqRing, sqRingSize);
+        ::close(ringFd);
+    }
+
+    void read(int fd, void* buffer, size_t length, uint64_t offset, Completion done) override {
+        enqueue(new Pending{std::move(done), IORING_OP_READ, fd, static_cast<char*>(buffer), length, offset, 0, 0});
+    }
+
+    // Регистрирует count буферов по bufferSize байт, лежащих подряд начиная с base
+    void registerBuffers(void* base, size_t bufferSize, unsigned count) {
+        iovec* vectors = new iovec[count];
+        for (unsigned i = 0; i < count; ++i) {
+            vectors[i].iov_base = static_cast<char*>(base) + i * bufferSize;
+            vectors[i].iov_len = bufferSize;
+        }
+        long result = ::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, vectors, count);
+        delete[] vectors;
+        if (result < 0) {
+            throw std::runtime_error(std::string("io_uring_register failed: ") + std::strerror(errno));
+        }
+    }
+
+    // Чтение в зарегистрированный буфер номер bufferIndex (buffer должен лежать внутри него)
+    void readFixed(int fd, void* buffer, size_t length, uint64_t offset, unsigned bufferIndex, Completion done) {
+        enqueue(new Pending{std::move(done), IORING_OP_READ_FIXED, fd, static_cast<char*>(buffer), length, offset,
+                            static_cast<uint16_t>(bufferIndex), 0});
+    }
+
+    size_t submit() override {
+        size_t submitted = 0;
+        while (unsubmitted != 0) {
+            int result = enter(ringFd, static_cast<unsigned>(unsubmitted), 0, 0);
+            if (result < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    reap(0);
+                    continue;
+                }
+                throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+            }
+            unsubmitted -= static_cast<size_t>(result);
+            submitted += static_cast<size_t>(result);
+        }
+        return submitted;
+    }
+
+    void wait() override {
+        while (pending != 0) {
+            submit();
+            reap(1);
+        }
+    }
+
+    size_t inFlight() const override {
+        return pending;
+    }
+
+    const char* name() const override {
+        return "io_uring";
+    }
+};
+
+#endif // L3_HAS_IO_URING
+
+// io_uring, если ядро его поддерживает, иначе пул потоков с pread
+inline IAsyncReader* makeAsyncReader(unsigned queueDepth = 1024) {
+#ifdef L3_HAS_IO_URING
+    if (UringReader::supported()) {
+        return new UringReader(queueDepth);
+    }
+#endif
+    return new ThreadPoolReader();
+}
+
+#endif //L3_ASYNCREADER_H
@@ -0,0 +1,372 @@
+#ifndef L3_BLOCKCACHE_H
+#define L3_BLOCKCACHE_H
+
+#include "LRUCache.h"
+#include "Hash.h"
+#include "IAsyncReader.h"
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <fcntl.h>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Ключ блока: реальный файл и номер блока в нём
+struct BlockKey {
+    std::string path;
+    uint64_t block;
+
+    bool operator==(const BlockKey& other) const {
+        return block == other.block && path == other.path;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const BlockKey& key) {
+    return out << key.path << "#" << key.block;
+}
+
+namespace std {
+template <>
+struct hash<BlockKey> {
+    size_t operator()(const BlockKey& key) const {
+        return static_cast<size_t>(hashing::hashBytes(key.path.data(), key.path.size(), key.block));
+    }
+};
+} // namespace std
+
+// Кэш содержимого реальных файлов блоками фиксированного размера. Блоки вытесняются по LRU,
+// объём ограничен суммарным размером блоков в байтах. Промах читает с диска один блок через pread,
+// повторное чтение того же диапазона на диск не обращается.
+// Содержимое файла считается неизменным, пока его блоки лежат в кэше.
+// Потокобезопасен: диск читается без блокировки, а блок, который уже загружается
+// (например, упреждающим чтением), второй раз не читается - его дожидаются
+class BlockCache {
+public:
+    static constexpr size_t defaultBlockSize = 64 * 1024;
+    static constexpr size_t defaultMaxBytes = 64 * 1024 * 1024;
+
+private:
+    using Cache = LRUCache<BlockKey, std::string>;
+
+    size_t blockSize_;
+    Cache blocks;
+    Dictionary<BlockKey, bool> loading; // Блоки, которые сейчас читаются с диска
+    mutable std::mutex mutex;
+    std::condition_variable loaded; // Какой-то блок дочитан
+    std::atomic<size_t> diskReads_; // Сколько блоков прочитано с диска
+
+    // Открытый файл и его размер на момент открытия; закрывается в деструкторе
+    struct OpenFile {
+        int fd = -1;
+        uint64_t size = 0;
+
+        OpenFile() = default;
+        OpenFile(const OpenFile&) = delete;
+        OpenFile& operator=(const OpenFile&) = delete;
+
+        ~OpenFile() {
+            close();
+        }
+
+        bool open(const std::string& path) {
+            close();
+            fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat info;
+            if (fd >= 0 && ::fstat(fd, &info) != 0) {
+                close();
+            }
+            size = fd >= 0 ? static_cast<uint64_t>(info.st_size) : 0;
+            return fd >= 0;
+        }
+
+        void close() {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    };
+
+    // Сколько байт блока block приходится на файл размера fileSize
+    size_t blockLength(uint64_t fileSize, uint64_t block) const {
+        uint64_t start = block * blockSize_;
+        if (start >= fileSize) {
+            return 0;
+        }
+        return fileSize - start < blockSize_ ? static_cast<size_t>(fileSize - start) : blockSize_;
+    }
+
+    // Читает блок целиком. Последний блок файла короче, блок за концом файла пуст:
+    // память выделяется ровно под данные, а не под полный блок
+    std::string loadBlock(const OpenFile& file, const std::string& path, uint64_t block) {
+        size_t length = blockLength(file.size, block);
+        std::string data(length, '\0');
+        if (length == 0) {
+            return data;
+        }
+        size_t filled = 0;
+        off_t offset = static_cast<off_t>(block * blockSize_);
+        while (filled < length) {
+            ssize_t read = ::pread(file.fd, &data[filled], length - filled, offset + static_cast<off_t>(filled));
+            if (read < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Cannot read file: " + path);
+            }
+            if (read == 0) {
+                break; // Файл укоротился после открытия
+            }
+            filled += static_cast<size_t>(read);
+        }
+        data.resize(filled);
+        ++diskReads_;
+        return data;
+    }
+
+    // Сколько файлов fetch может держать открытыми одновременно
+    static size_t openFileBudget() {
+        rlimit limit;
+        if (::getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+            return 1024;
+        }
+        size_t budget = static_cast<size_t>(limit.rlim_cur / 2);
+        return budget == 0 ? 1 : budget;
+    }
+
+    // Вызывается под блокировкой. Возвращает закэшированный блок или nullptr - тогда блок
+    // помечен как загружаемый, и вызывающий обязан загрузить его и вызвать finishLoad
+    const std::string* acquire(const BlockKey& key, std::unique_lock<std::mutex>& lock) {
+        while (true) {
+            if (const std::string* data = blocks.find(key)) {
+                return data;
+            }
+            if (!loading.contains_key(key)) {
+                loading.add(key, true);
+                return nullptr;
+            }
+            loaded.wait(lock);
+        }
+    }
+
+    // Снимает отметку загрузки и кладёт блок в кэш (data == nullptr - загрузка не удалась)
+    void finishLoad(BlockKey&& key, std::string* data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loading.remove(key);
+            if (data) {
+                blocks.insert(std::move(key), std::move(*data));
+            }
+        }
+        loaded.notify_all();
+    }
+
+    // Загружает помеченный блок; файл открывается при первой необходимости
+    std::string loadMarked(OpenFile& file, const std::string& path, const BlockKey& key) {
+        try {
+            if (file.fd < 0 && !file.open(path)) {
+                throw std::runtime_error("Cannot open file: " + path);
+            }
+            return loadBlock(file, path, key.block);
+        } catch (...) {
+            finishLoad(BlockKey(key), nullptr);
+            throw;
+        }
+    }
+
+public:
+    explicit BlockCache(size_t maxBytes = defaultMaxBytes, size_t blockSize = defaultBlockSize)
+        : blockSize_(blockSize), blocks(Cache::unlimited, maxBytes), diskReads_(0) {
+        if (blockSize == 0) {
+            throw std::invalid_argument("Block size must be positive");
+        }
+    }
+
+    // Читает до length байт файла path начиная с offset. За концом файла возвращает меньше (или пустую строку)
+    std::string read(const std::string& path, uint64_t offset, size_t length) {
+        std::string result;
+        if (length == 0) {
+            return result;
+        }
+        result.reserve(length);
+        OpenFile file; // Открывается только при первом промахе
+        uint64_t end = offset + length;
+        for (uint64_t block = offset / blockSize_; block * blockSize_ < end; ++block) {
+            uint64_t blockStart = block * blockSize_;
+            uint64_t from = offset > blockStart ? offset - blockStart : 0;
+            auto append = [&](const std::string& data) {
+                uint64_t to = end - blockStart < data.size() ? end - blockStart : data.size();
+                if (from < to) {
+                    result.append(data, from, to - from);
+                }
+                return data.size() < blockSize_; // Последний блок файла
+            };
+
+            BlockKey key{path, block};
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                const std::string* data = acquire(key, lock);
+                if (data) {
+                    if (append(*data)) {
+                        break;
+                    }
+                    continue;
+                }
+            }
+            std::string data = loadMarked(file, path, key);
+            if (data.empty()) {
+                // Блок за концом файла не кэшируется: его вес 0, и такие записи копились бы вне maxBytes
+                finishLoad(std::move(key), nullptr);
+                break;
+            }
+            bool lastBlock = append(data);
+            finishLoad(std::move(key), &data);
+            if (lastBlock) {
+                break; // Дальше файла нет
+            }
+        }
+        return result;
+    }
+
+    // Загружает в кэш блоки [firstBlock, firstBlock + count) файла path, которых там ещё нет.
+    // За конец файла (по его текущему размеру) не заходит. Возвращает количество прочитанных с диска блоков
+    size_t prefetch(const std::string& path, uint64_t firstBlock, size_t count) {
+        size_t fetched = 0;
+        OpenFile file;
+        if (!file.open(path)) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        uint64_t fileBlocks = (file.size + blockSize_ - 1) / blockSize_;
+        uint64_t last = firstBlock + count < fileBlocks ? firstBlock + count : fileBlocks; // За концом файла не читаем
+        for (uint64_t block = firstBlock; block < last; ++block) {
+            BlockKey key{path, block};
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                // contains не меняет порядок LRU: упреждающее чтение не должно продлевать жизнь блокам
+                if (blocks.contains(key) || loading.contains_key(key)) {
+                    continue;
+                }
+                loading.add(key, true);
+            }
+            std::string data = loadMarked(file, path, key);
+            bool lastBlock = data.size() < blockSize_;
+            finishLoad(std::move(key), &data);
+            ++fetched;
+            if (lastBlock) {
+                break;
+            }
+        }
+        return fetched;
+    }
+
+    // Загружает блоки keys одной пачкой через io: все запросы уходят сразу, блоки попадают в кэш
+    // из обработчиков завершения. Возвращает управление, когда все запросы завершены.
+    // Уже закэшированные и загружаемые блоки пропускаются. Ключи одного файла лучше передавать
+    // подряд - файл тогда открывается один раз. Открытых файлов не больше половины лимита
+    // дескрипторов: когда он исчерпан, накопленная пачка дочитывается и файлы закрываются.
+    // Если какой-то файл открыть не удалось, остальные блоки всё равно загружаются,
+    // а в конце выбрасывается исключение. Возвращает количество прочитанных с диска блоков
+    size_t fetch(IAsyncReader& io, const BlockKey* keys, size_t count) {
+        size_t maxOpen = openFileBudget();
+        OpenFile* files = new OpenFile[count < maxOpen ? count : maxOpen]; // Открыты до завершения своих запросов
+        size_t fileCount = 0;
+        const std::string* openPath = nullptr;
+        std::string failedPath;
+        size_t fetched = 0;
+        auto flush = [&] {
+            io.wait();
+            for (size_t i = 0; i < fileCount; ++i) {
+                files[i].close();
+            }
+            fileCount = 0;
+        };
+        for (size_t i = 0; i < count; ++i) {
+            const BlockKey& key = keys[i];
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (blocks.contains(key) || loading.contains_key(key)) {
+                    continue;
+                }
+                loading.add(key, true);
+            }
+            if (!openPath || *openPath != key.path) {
+                openPath = nullptr;
+                if (fileCount == maxOpen) {
+                    flush();
+                }
+                bool opened = files[fileCount].open(key.path);
+                if (!opened && (errno == EMFILE || errno == ENFILE) && fileCount != 0) {
+                    flush(); // Дескрипторы заняты кем-то ещё - освобождаем свои и пробуем снова
+                    opened = files[0].open(key.path);
+                }
+                if (!opened) {
+                    if (failedPath.empty()) {
+                        failedPath = key.path;
+                    }
+                    finishLoad(BlockKey(key), nullptr);
+                    continue;
+                }
+                ++fileCount;
+                openPath = &key.path;
+            }
+            size_t length = blockLength(files[fileCount - 1].size, key.block);
+            if (length == 0) { // За концом файла: читать нечего, пустые блоки в кэш не кладём
+                finishLoad(BlockKey(key), nullptr);
+                continue;
+            }
+            std::string* data = new std::string(length, '\0');
+            io.read(files[fileCount - 1].fd, &(*data)[0], length, key.block * blockSize_,
+                    [this, key = BlockKey(key), data, &fetched](ssize_t result) mutable {
+                        // Неполный блок в кэш не кладётся: read принял бы его за конец файла
+                        if (result == static_cast<ssize_t>(data->size())) {
+                            ++diskReads_;
+                            ++fetched;
+                            finishLoad(std::move(key), data);
+                        } else {
+                            finishLoad(std::move(key), nullptr);
+                        }
+                        delete data;
+                    });
+        }
+        flush(); // Обработчики вызываются здесь, в этом потоке
+        delete[] files;
+        if (!failedPath.empty()) {
+            throw std::runtime_error("Cannot open file: " + failedPath);
+        }
+        return fetched;
+    }
+
+    size_t blockSize() const {
+        return blockSize_;
+    }
+
+    size_t diskReads() const {
+        return diskReads_;
+    }
+
+    // Сколько байт занимают закэшированные блоки
+    size_t bytesCached() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return blocks.weight();
+    }
+
+    // Сколько блоков лежит в кэше
+    size_t blocksCached() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return blocks.size();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks.clear();
+    }
+};
+
+#endif //L3_BLOCKCACHE_H
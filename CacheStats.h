@@ -0,0 +1,172 @@
+#ifndef L3_CACHESTATS_H
+#define L3_CACHESTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+// Гистограмма задержек с логарифмическими корзинами: в корзину i попадают значения
+// из [2^(i-1), 2^i) наносекунд (в корзину 0 - нулевые)
+struct LatencyHistogram {
+    static constexpr size_t bucketCount = 40; // До 2^39 нс (~9 минут)
+
+    uint64_t buckets[bucketCount] = {};
+
+    static size_t bucketOf(uint64_t nanoseconds) {
+        size_t bucket = 0;
+        while (nanoseconds != 0 && bucket + 1 < bucketCount) {
+            nanoseconds >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    uint64_t count() const {
+        uint64_t total = 0;
+        for (uint64_t bucket : buckets) {
+            total += bucket;
+        }
+        return total;
+    }
+
+    // Верхняя граница (в наносекундах) корзины, в которую попадает квантиль q (0.5 - медиана)
+    uint64_t percentile(double q) const {
+        uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucketCount; ++i) {
+            seen += buckets[i];
+            if (seen > rank || seen == total) {
+                return i == 0 ? 0 : (uint64_t(1) << i);
+            }
+        }
+        return uint64_t(1) << (bucketCount - 1);
+    }
+
+    LatencyHistogram& operator+=(const LatencyHistogram& other) {
+        for (size_t i = 0; i < bucketCount; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        return *this;
+    }
+};
+
+// Снимок статистики кэша
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t insertions = 0; // Новые элементы (обновление существующего ключа не считается)
+    uint64_t evictions = 0; // Вытеснения из-за ограничений по количеству или весу
+    uint64_t expirations = 0; // Удаления просроченных элементов
+    uint64_t bytesResident = 0; // Суммарный вес элементов в момент снимка
+    LatencyHistogram getLatency; // get/find
+    LatencyHistogram accessLatency; // access/insert
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+
+    CacheStats& operator+=(const CacheStats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        insertions += other.insertions;
+        evictions += other.evictions;
+        expirations += other.expirations;
+        bytesResident += other.bytesResident;
+        getLatency += other.getLatency;
+        accessLatency += other.accessLatency;
+        return *this;
+    }
+};
+
+// Политика статистики "выключено": все методы пустые и полностью убираются компилятором
+struct NoStats {
+    static constexpr bool enabled = false;
+
+    static uint64_t startTimer() { return 0; }
+    void recordHit() {}
+    void recordMiss() {}
+    void recordInsertion() {}
+    void recordEviction() {}
+    void recordExpiration() {}
+    void recordGetLatency(uint64_t) {}
+    void recordAccessLatency(uint64_t) {}
+    CacheStats snapshot() const { return {}; }
+};
+
+// Политика статистики на атомарных счётчиках. Счётчики разбиты на полосы по потокам
+// (каждая в своей кэш-линии), так что потоки почти не пишут в общие линии
+class AtomicStats {
+public:
+    static constexpr bool enabled = true;
+
+private:
+    static constexpr size_t stripeCount = 8;
+
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> insertions{0};
+        std::atomic<uint64_t> evictions{0};
+        std::atomic<uint64_t> expirations{0};
+        std::atomic<uint64_t> getLatency[LatencyHistogram::bucketCount] = {};
+        std::atomic<uint64_t> accessLatency[LatencyHistogram::bucketCount] = {};
+    };
+
+    Stripe stripes[stripeCount];
+
+    Stripe& local() {
+        static thread_local size_t index = std::hash<std::thread::id>{}(std::this_thread::get_id()) % stripeCount;
+        return stripes[index];
+    }
+
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static uint64_t nowNanoseconds() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+public:
+    static uint64_t startTimer() { return nowNanoseconds(); }
+    void recordHit() { bump(local().hits); }
+    void recordMiss() { bump(local().misses); }
+    void recordInsertion() { bump(local().insertions); }
+    void recordEviction() { bump(local().evictions); }
+    void recordExpiration() { bump(local().expirations); }
+
+    void recordGetLatency(uint64_t started) {
+        bump(local().getLatency[LatencyHistogram::bucketOf(nowNanoseconds() - started)]);
+    }
+
+    void recordAccessLatency(uint64_t started) {
+        bump(local().accessLatency[LatencyHistogram::bucketOf(nowNanoseconds() - started)]);
+    }
+
+    CacheStats snapshot() const {
+        CacheStats result;
+        for (const Stripe& stripe : stripes) {
+            result.hits += stripe.hits.load(std::memory_order_relaxed);
+            result.misses += stripe.misses.load(std::memory_order_relaxed);
+            result.insertions += stripe.insertions.load(std::memory_order_relaxed);
+            result.evictions += stripe.evictions.load(std::memory_order_relaxed);
+            result.expirations += stripe.expirations.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < LatencyHistogram::bucketCount; ++i) {
+                result.getLatency.buckets[i] += stripe.getLatency[i].load(std::memory_order_relaxed);
+                result.accessLatency.buckets[i] += stripe.accessLatency[i].load(std::memory_order_relaxed);
+            }
+        }
+        return result;
+    }
+};
+
+#endif //L3_CACHESTATS_H
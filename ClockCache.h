@@ -0,0 +1,244 @@
+#ifndef L3_CLOCKCACHE_H
+#define L3_CLOCKCACHE_H
+
+#include "ICache.h"
+#include "ConcurrentDictionary.h"
+#include "Epoch.h"
+#include "Hash.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// Приближённый LRU-кэш (алгоритм CLOCK) для нагрузок, где чтений много больше, чем записей.
+// Попадание не меняет порядок элементов, а только выставляет атомарный бит обращения элемента
+// и не берёт никаких блокировок: индекс ключей - ConcurrentDictionary с чтением без блокировок,
+// а элементы после вставки не меняются (новое значение - новый элемент) и освобождаются
+// через reclamation::retire, когда их уже никто не читает.
+// При вытеснении "стрелка" обходит фиксированный массив слотов: элемент с выставленным битом
+// получает второй шанс (бит сбрасывается), первый элемент без бита вытесняется.
+// Вставки распределяются по хэшу между независимыми сегментами со своими слотами, стрелкой
+// и мьютексом, так что писатели разных сегментов друг другу не мешают
+template <typename Key, typename Value, typename Hash = DefaultHash<Key>>
+class ClockCache : public ICache<Key, Value> {
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t slot; // Номер слота в сегменте, меняется только под мьютексом сегмента
+        std::atomic<bool> referenced{false}; // Бит обращения
+
+        Entry(const Key& key, const Value& value, size_t slot) : key(key), value(value), slot(slot) {}
+    };
+
+    struct alignas(64) Segment { // Выравнивание, чтобы мьютексы соседних сегментов не делили кэш-линию
+        size_t capacity;
+        Entry** slots; // Фиксированный массив слотов, читается и меняется только под mutex
+        size_t used = 0; // Сколько слотов занято
+        size_t hand = 0; // Позиция стрелки
+        std::mutex mutex; // Только для вставок, вытеснения и обхода
+
+        explicit Segment(size_t capacity) : capacity(capacity), slots(new Entry*[capacity]) {}
+
+        Segment(const Segment&) = delete;
+        Segment& operator=(const Segment&) = delete;
+
+        ~Segment() {
+            for (size_t i = 0; i < used; ++i) {
+                delete slots[i];
+            }
+            delete[] slots;
+        }
+    };
+
+    Segment** segments;
+    size_t segmentCount_;
+    size_t capacity_;
+    Hash hash;
+    ConcurrentDictionary<Key, Entry*, Hash> index; // Ключ -> элемент
+
+    // Младшие биты хэша полоса индекса использует для выбора ячейки, поэтому сегмент выбираем по старшим
+    Segment& segmentFor(const Key& key) const {
+        uint64_t h = static_cast<uint64_t>(hash(key));
+        return *segments[static_cast<size_t>((h >> 32) % segmentCount_)];
+    }
+
+    // Помечаем элемент как использованный. Пишем в кэш-линию, только если бит ещё не выставлен,
+    // чтобы повторные попадания в горячий ключ не гоняли линию между ядрами
+    static void touch(Entry& entry) {
+        if (!entry.referenced.load(std::memory_order_relaxed)) {
+            entry.referenced.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // Вызывается внутри Guard: элемент остаётся действительным до его конца
+    Entry* lookup(const Key& key) const {
+        Entry* entry = nullptr;
+        return index.try_get(key, entry) ? entry : nullptr;
+    }
+
+    // Вызывается под мьютексом сегмента. Освобождает слот и возвращает его номер
+    size_t evict(Segment& segment) {
+        while (true) {
+            Entry* entry = segment.slots[segment.hand];
+            size_t current = segment.hand;
+            segment.hand = (segment.hand + 1) % segment.capacity;
+            if (entry->referenced.load(std::memory_order_relaxed)) {
+                entry->referenced.store(false, std::memory_order_relaxed); // Второй шанс
+            } else {
+                index.remove(entry->key);
+                reclamation::retire(entry);
+                return current;
+            }
+        }
+    }
+
+public:
+    static constexpr size_t minSegmentCapacity = 64; // Меньшие сегменты заметно хуже приближают LRU
+
+    // Количество сегментов по умолчанию - число аппаратных потоков, но сегмент не меньше minSegmentCapacity
+    static size_t defaultSegmentCount(size_t capacity) {
+        unsigned threads = std::thread::hardware_concurrency();
+        size_t count = threads == 0 ? 16 : threads;
+        size_t limit = capacity / minSegmentCapacity;
+        return limit == 0 ? 1 : count < limit ? count : limit;
+    }
+
+    // capacity делится между сегментами поровну, остаток достаётся первым сегментам
+    explicit ClockCache(size_t capacity, size_t segmentCount = 0, const Hash& hash = Hash())
+        : segmentCount_(segmentCount == 0 ? defaultSegmentCount(capacity) : segmentCount),
+          capacity_(capacity), hash(hash), index(ConcurrentDictionary<Key, Entry*, Hash>::defaultStripeCount(), hash) {
+        segments = new Segment*[segmentCount_];
+        for (size_t i = 0; i < segmentCount_; ++i) {
+            segments[i] = new Segment(capacity_ / segmentCount_ + (i < capacity_ % segmentCount_ ? 1 : 0));
+        }
+    }
+
+    ClockCache(const ClockCache&) = delete;
+    ClockCache& operator=(const ClockCache&) = delete;
+
+    ~ClockCache() override {
+        for (size_t i = 0; i < segmentCount_; ++i) {
+            delete segments[i];
+        }
+        delete[] segments;
+    }
+
+    // Новое значение существующего ключа - новый элемент на том же слоте, старый освобождается позже
+    void access(const Key& key, const Value& value) override {
+        Segment& segment = segmentFor(key);
+        std::lock_guard<std::mutex> lock(segment.mutex);
+        if (Entry* old = lookup(key)) {
+            Entry* entry = new Entry(key, value, old->slot);
+            entry->referenced.store(true, std::memory_order_relaxed);
+            segment.slots[entry->slot] = entry;
+            index.add(key, entry);
+            reclamation::retire(old);
+            return;
+        }
+        if (segment.capacity == 0) {
+            return;
+        }
+        size_t position = segment.used < segment.capacity ? segment.used++ : evict(segment);
+        Entry* entry = new Entry(key, value, position); // Новый элемент ещё не заслужил второй шанс
+        segment.slots[position] = entry;
+        index.add(key, entry);
+    }
+
+    bool contains(const Key& key) const override {
+        return index.contains_key(key);
+    }
+
+    // Ссылка действительна, пока другой поток не заменит или не вытеснит элемент.
+    // Для конкурентного доступа используйте try_get
+    Value& get(const Key& key) override {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    const Value& get(const Key& key) const override {
+        reclamation::Guard guard;
+        Entry* entry = lookup(key);
+        if (!entry) {
+            throw std::runtime_error("Key not found");
+        }
+        touch(*entry);
+        return entry->value;
+    }
+
+    // Указатель действителен, пока другой поток не заменит или не вытеснит элемент
+    Value* find(const Key& key) override {
+        reclamation::Guard guard;
+        Entry* entry = lookup(key);
+        if (!entry) {
+            return nullptr;
+        }
+        touch(*entry);
+        return &entry->value;
+    }
+
+    // Копирует значение без блокировок: элемент не освобождается, пока открыт Guard
+    bool try_get(const Key& key, Value& out) override {
+        reclamation::Guard guard;
+        Entry* entry = lookup(key);
+        if (!entry) {
+            return false;
+        }
+        touch(*entry);
+        out = entry->value;
+        return true;
+    }
+
+    bool concurrent() const override {
+        return true;
+    }
+
+    size_t size() const override {
+        size_t total = 0;
+        for (size_t i = 0; i < segmentCount_; ++i) {
+            std::lock_guard<std::mutex> lock(segments[i]->mutex);
+            total += segments[i]->used;
+        }
+        return total;
+    }
+
+    void print() const override {
+        std::cout << "Cache contents:\n";
+        for (size_t s = 0; s < segmentCount_; ++s) {
+            Segment& segment = *segments[s];
+            std::lock_guard<std::mutex> lock(segment.mutex);
+            for (size_t i = 0; i < segment.used; ++i) {
+                const Entry& entry = *segment.slots[(segment.hand + i) % segment.used];
+                std::cout << "Key: " << entry.key << ", Value: " << entry.value
+                          << (entry.referenced.load(std::memory_order_relaxed) ? " *" : "") << "\n";
+            }
+        }
+    }
+
+    void clear() override {
+        for (size_t s = 0; s < segmentCount_; ++s) {
+            Segment& segment = *segments[s];
+            std::lock_guard<std::mutex> lock(segment.mutex);
+            for (size_t i = 0; i < segment.used; ++i) {
+                index.remove(segment.slots[i]->key);
+                reclamation::retire(segment.slots[i]);
+            }
+            segment.used = 0;
+            segment.hand = 0;
+        }
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t segmentCount() const {
+        return segmentCount_;
+    }
+};
+
+#endif //L3_CLOCKCACHE_H
@@ -0,0 +1,339 @@
+#ifndef L3_CONCURRENTDICTIONARY_H
+#define L3_CONCURRENTDICTIONARY_H
+
+#include "Dictionary.h"
+#include "Epoch.h"
+#include "Hash.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Потокобезопасный словарь с чтением без блокировок. Ключи распределяются по полосам, у каждой полосы
+// своя таблица цепочек и свой мьютекс, который берут только писатели. Узлы после публикации не меняются:
+// изменение значения создаёт новый узел, а старый (как и удалённый) освобождается через reclamation::retire,
+// когда его уже не может читать ни один поток. Поэтому читатель только открывает Guard эпохи
+// и проходит по цепочке - без мьютексов и без записи в общие кэш-линии.
+// Расширение полосы строит новую таблицу рядом со старой и публикует её одной атомарной записью:
+// читатели продолжают работать со старой, остальные полосы расширение не замечают.
+// Ссылки на значения наружу не выдаются - элемент может быть удалён сразу после чтения, -
+// поэтому get и find копируют значение, а изменение на месте делается через update.
+// Хэш-функция Hash общая для выбора полосы и ячейки; для ключей, которые может
+// подобрать злоумышленник, передайте DefaultHash<Key>::seeded()
+template <typename Key, typename Value, typename Hash = DefaultHash<Key>>
+class ConcurrentDictionary {
+private:
+    struct Node {
+        size_t hash;
+        Key key;
+        Value value;
+        std::atomic<Node*> next;
+
+        template <typename K, typename V>
+        Node(size_t hash, K&& key, V&& value, Node* next)
+            : hash(hash), key(std::forward<K>(key)), value(std::forward<V>(value)), next(next) {}
+    };
+
+    struct Table {
+        std::atomic<Node*>* buckets;
+        size_t mask; // Размер - степень двойки
+        bool ownsNodes = false; // Удалять ли узлы вместе с таблицей (таблица вышла из употребления целиком)
+
+        explicit Table(size_t size) : buckets(new std::atomic<Node*>[size]), mask(size - 1) {
+            for (size_t i = 0; i < size; ++i) {
+                buckets[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        Table(const Table&) = delete;
+        Table& operator=(const Table&) = delete;
+
+        ~Table() {
+            if (ownsNodes) {
+                for (size_t i = 0; i <= mask; ++i) {
+                    Node* node = buckets[i].load(std::memory_order_relaxed);
+                    while (node) {
+                        Node* next = node->next.load(std::memory_order_relaxed);
+                        delete node;
+                        node = next;
+                    }
+                }
+            }
+            delete[] buckets;
+        }
+    };
+
+    struct alignas(64) Stripe { // Выравнивание, чтобы соседние полосы не делили кэш-линию
+        std::mutex mutex; // Только для писателей
+        std::atomic<Table*> table;
+        std::atomic<size_t> count{0};
+
+        Stripe() : table(new Table(initialBuckets)) {}
+    };
+
+    static constexpr size_t initialBuckets = 8;
+
+    Stripe* stripes;
+    size_t stripeCount_; // Степень двойки
+    size_t mask;
+    Hash hasher;
+
+    size_t hash(const Key& key) const {
+        uint64_t h = static_cast<uint64_t>(hasher(key));
+        if constexpr (!IsAvalanching<Hash>::value) {
+            h = hashing::fmix64(h); // Сторонний хэш может быть тождественным
+        }
+        return static_cast<size_t>(h);
+    }
+
+    // Полоса - по старшим битам хэша, ячейка внутри полосы - по младшим
+    Stripe& stripeFor(size_t h) const {
+        return stripes[static_cast<size_t>(static_cast<uint64_t>(h) >> 40) & mask];
+    }
+
+    // Вызывается внутри Guard. Узел остаётся действительным до конца Guard
+    Node* lookup(const Stripe& stripe, size_t h, const Key& key) const {
+        Table* table = stripe.table.load();
+        for (Node* node = table->buckets[h & table->mask].load(); node; node = node->next.load()) {
+            if (node->hash == h && node->key == key) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    // Вызывается под мьютексом полосы. Ссылка на указатель, ведущий к узлу с ключом key
+    // (или на конец цепочки, если ключа нет)
+    std::atomic<Node*>& link(Table* table, size_t h, const Key& key) {
+        std::atomic<Node*>* current = &table->buckets[h & table->mask];
+        while (Node* node = current->load(std::memory_order_relaxed)) {
+            if (node->hash == h && node->key == key) {
+                break;
+            }
+            current = &node->next;
+        }
+        return *current;
+    }
+
+    // Вызывается под мьютексом полосы. Переносит узлы в таблицу нужного размера; старая таблица
+    // вместе с узлами удаляется, когда её дочитают
+    void rebuild(Stripe& stripe, size_t size) {
+        Table* old = stripe.table.load(std::memory_order_relaxed);
+        Table* table = new Table(size);
+        for (size_t i = 0; i <= old->mask; ++i) {
+            for (Node* node = old->buckets[i].load(std::memory_order_relaxed); node;
+                 node = node->next.load(std::memory_order_relaxed)) {
+                std::atomic<Node*>& head = table->buckets[node->hash & table->mask];
+                head.store(new Node(node->hash, node->key, node->value, head.load(std::memory_order_relaxed)),
+                           std::memory_order_relaxed);
+            }
+        }
+        stripe.table.store(table);
+        old->ownsNodes = true;
+        reclamation::retire(old);
+    }
+
+    // Вызывается под мьютексом полосы. Заменяет узел или добавляет новый. Возвращает true, если ключа не было
+    template <typename K, typename V>
+    bool put(Stripe& stripe, size_t h, K&& key, V&& value) {
+        Table* table = stripe.table.load(std::memory_order_relaxed);
+        std::atomic<Node*>& place = link(table, h, key);
+        Node* old = place.load(std::memory_order_relaxed);
+        if (old) {
+            place.store(new Node(h, std::forward<K>(key), std::forward<V>(value), old->next.load(std::memory_order_relaxed)));
+            reclamation::retire(old);
+            return false;
+        }
+        std::atomic<Node*>& head = table->buckets[h & table->mask];
+        head.store(new Node(h, std::forward<K>(key), std::forward<V>(value), head.load(std::memory_order_relaxed)));
+        size_t count = stripe.count.load(std::memory_order_relaxed) + 1;
+        stripe.count.store(count, std::memory_order_relaxed);
+        if (count > table->mask + 1) { // Средняя длина цепочки не больше 1
+            rebuild(stripe, (table->mask + 1) * 2);
+        }
+        return true;
+    }
+
+public:
+    // По умолчанию - несколько полос на аппаратный поток, чтобы писатели редко сталкивались
+    static size_t defaultStripeCount() {
+        unsigned threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 64 : threads * 4;
+    }
+
+    explicit ConcurrentDictionary(size_t stripeCount = defaultStripeCount(), const Hash& hash = Hash())
+        : hasher(hash) {
+        if (stripeCount == 0) {
+            throw std::invalid_argument("Stripe count must be positive");
+        }
+        stripeCount_ = 1;
+        while (stripeCount_ < stripeCount) {
+            stripeCount_ <<= 1;
+        }
+        mask = stripeCount_ - 1;
+        stripes = new Stripe[stripeCount_];
+    }
+
+    ConcurrentDictionary(const ConcurrentDictionary&) = delete;
+    ConcurrentDictionary& operator=(const ConcurrentDictionary&) = delete;
+
+    // Читателей к этому моменту быть не должно, поэтому таблицы удаляются сразу
+    ~ConcurrentDictionary() {
+        for (size_t i = 0; i < stripeCount_; ++i) {
+            Table* table = stripes[i].table.load();
+            table->ownsNodes = true;
+            delete table;
+        }
+        delete[] stripes;
+    }
+
+    // При параллельных изменениях - снимок, полосы считываются по очереди
+    size_t count() const {
+        size_t total = 0;
+        for (size_t i = 0; i < stripeCount_; ++i) {
+            total += stripes[i].count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    size_t capacity() const {
+        reclamation::Guard guard;
+        size_t total = 0;
+        for (size_t i = 0; i < stripeCount_; ++i) {
+            total += stripes[i].table.load()->mask + 1;
+        }
+        return total;
+    }
+
+    bool contains_key(const Key& key) const {
+        size_t h = hash(key);
+        reclamation::Guard guard;
+        return lookup(stripeFor(h), h, key) != nullptr;
+    }
+
+    // Копирует значение без блокировок. При промахе возвращает false
+    bool try_get(const Key& key, Value& out) const {
+        size_t h = hash(key);
+        reclamation::Guard guard;
+        Node* node = lookup(stripeFor(h), h, key);
+        if (!node) {
+            return false;
+        }
+        out = node->value;
+        return true;
+    }
+
+    Value get_copy(const Key& key) const {
+        Value value;
+        if (!try_get(key, value)) {
+            throw std::runtime_error("Key not found");
+        }
+        return value;
+    }
+
+    // Добавляет элемент или заменяет значение существующего
+    void add(const Key& key, const Value& value) {
+        size_t h = hash(key);
+        Stripe& stripe = stripeFor(h);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        put(stripe, h, key, value);
+    }
+
+    void add(Key&& key, Value&& value) {
+        size_t h = hash(key);
+        Stripe& stripe = stripeFor(h);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        put(stripe, h, std::move(key), std::move(value));
+    }
+
+    // Атомарно добавляет элемент, только если ключа ещё нет. Возвращает true, если добавил
+    bool add_if_absent(const Key& key, const Value& value) {
+        size_t h = hash(key);
+        Stripe& stripe = stripeFor(h);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        if (link(stripe.table.load(std::memory_order_relaxed), h, key).load(std::memory_order_relaxed)) {
+            return false;
+        }
+        return put(stripe, h, key, value);
+    }
+
+    void remove(const Key& key) {
+        size_t h = hash(key);
+        Stripe& stripe = stripeFor(h);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        std::atomic<Node*>& place = link(stripe.table.load(std::memory_order_relaxed), h, key);
+        Node* node = place.load(std::memory_order_relaxed);
+        if (!node) {
+            throw std::runtime_error("Key not found");
+        }
+        place.store(node->next.load(std::memory_order_relaxed)); // Читатель на node всё ещё дойдёт до конца цепочки
+        stripe.count.store(stripe.count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        reclamation::retire(node);
+    }
+
+    // Изменяет значение под мьютексом полосы: update(key, [](Value& v) { ++v; }). Читатели видят
+    // либо старое значение, либо новое целиком. Возвращает false, если ключа нет
+    template <typename Updater>
+    bool update(const Key& key, Updater&& updater) {
+        size_t h = hash(key);
+        Stripe& stripe = stripeFor(h);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        Node* node = link(stripe.table.load(std::memory_order_relaxed), h, key).load(std::memory_order_relaxed);
+        if (!node) {
+            return false;
+        }
+        Value value = node->value;
+        updater(value);
+        put(stripe, h, key, std::move(value));
+        return true;
+    }
+
+    // Обходит полосы по очереди без блокировок; элементы, изменённые во время обхода,
+    // могут попасть в него в старом или новом виде
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const {
+        reclamation::Guard guard;
+        for (size_t i = 0; i < stripeCount_; ++i) {
+            Table* table = stripes[i].table.load();
+            for (size_t b = 0; b <= table->mask; ++b) {
+                for (Node* node = table->buckets[b].load(); node; node = node->next.load()) {
+                    visitor(static_cast<const Key&>(node->key), static_cast<const Value&>(node->value));
+                }
+            }
+        }
+    }
+
+    // Резервирует место под n элементов, поровну между полосами
+    void reserve(size_t n) {
+        size_t perStripe = n / stripeCount_ + 1;
+        for (size_t i = 0; i < stripeCount_; ++i) {
+            std::lock_guard<std::mutex> lock(stripes[i].mutex);
+            size_t size = stripes[i].table.load(std::memory_order_relaxed)->mask + 1;
+            if (size < perStripe) {
+                while (size < perStripe) {
+                    size <<= 1;
+                }
+                rebuild(stripes[i], size);
+            }
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < stripeCount_; ++i) {
+            std::lock_guard<std::mutex> lock(stripes[i].mutex);
+            Table* old = stripes[i].table.load(std::memory_order_relaxed);
+            stripes[i].table.store(new Table(initialBuckets));
+            stripes[i].count.store(0, std::memory_order_relaxed);
+            old->ownsNodes = true;
+            reclamation::retire(old);
+        }
+    }
+
+    size_t stripeCount() const {
+        return stripeCount_;
+    }
+};
+
+#endif //L3_CONCURRENTDICTIONARY_H
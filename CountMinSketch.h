@@ -0,0 +1,96 @@
+#ifndef L3_COUNTMINSKETCH_H
+#define L3_COUNTMINSKETCH_H
+
+#include "Hash.h"
+#include <cstddef>
+#include <cstdint>
+
+// Count-min sketch - приближённый счётчик частот обращений к ключам.
+// Хранит depth строк по width 4-битных счётчиков (насыщаются на 15, по два в байте), оценка частоты -
+// минимум по строкам. После sampleSize увеличений все счётчики делятся пополам (старение),
+// чтобы давно популярные ключи не занимали кэш вечно
+template <typename Key>
+class CountMinSketch {
+private:
+    static constexpr size_t depth = 4; // Количество строк (независимых хэш-функций)
+    static constexpr uint8_t maxCount = 15; // Предел 4-битного счётчика
+
+    uint8_t* counters; // depth * width / 2 байт: счётчик i - младшая (чётный i) или старшая половина байта i / 2
+    size_t width; // Ширина строки, степень двойки
+    size_t sampleSize; // Через сколько увеличений выполнять старение
+    size_t additions; // Увеличений с момента последнего старения
+
+    size_t indexOf(uint64_t hash, size_t row) const {
+        // Для каждой строки - свой сдвиг исходного хэша
+        return row * width + (hashing::fmix64(hash + row * 0x9e3779b97f4a7c15ULL) & (width - 1));
+    }
+
+    size_t bytes() const {
+        return depth * width / 2; // width - степень двойки не меньше 16, делится нацело
+    }
+
+    uint8_t counterAt(size_t index) const {
+        return static_cast<uint8_t>((counters[index / 2] >> (index % 2 * 4)) & 0x0F);
+    }
+
+    void age() {
+        // Сдвиг всего байта делит пополам оба счётчика; маска убирает бит, перешедший из старшего в младший
+        for (size_t i = 0; i < bytes(); ++i) {
+            counters[i] = static_cast<uint8_t>((counters[i] >> 1) & 0x77);
+        }
+        additions /= 2;
+    }
+
+public:
+    // expectedKeys - сколько различных ключей нужно различать (обычно ёмкость кэша)
+    explicit CountMinSketch(size_t expectedKeys) : width(16), additions(0) {
+        while (width < expectedKeys) {
+            width <<= 1;
+        }
+        sampleSize = 10 * (expectedKeys == 0 ? 1 : expectedKeys);
+        counters = new uint8_t[bytes()]();
+    }
+
+    CountMinSketch(const CountMinSketch&) = delete;
+    CountMinSketch& operator=(const CountMinSketch&) = delete;
+
+    ~CountMinSketch() {
+        delete[] counters;
+    }
+
+    void increment(const Key& key) {
+        uint64_t hash = DefaultHash<Key>{}(key);
+        bool changed = false;
+        for (size_t row = 0; row < depth; ++row) {
+            size_t index = indexOf(hash, row);
+            if (counterAt(index) < maxCount) {
+                counters[index / 2] = static_cast<uint8_t>(counters[index / 2] + (1 << (index % 2 * 4)));
+                changed = true;
+            }
+        }
+        if (changed && ++additions >= sampleSize) {
+            age();
+        }
+    }
+
+    uint8_t estimate(const Key& key) const {
+        uint64_t hash = DefaultHash<Key>{}(key);
+        uint8_t result = maxCount;
+        for (size_t row = 0; row < depth; ++row) {
+            uint8_t counter = counterAt(indexOf(hash, row));
+            if (counter < result) {
+                result = counter;
+            }
+        }
+        return result;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < bytes(); ++i) {
+            counters[i] = 0;
+        }
+        additions = 0;
+    }
+};
+
+#endif //L3_COUNTMINSKETCH_H
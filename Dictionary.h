@@ -3,229 +3,752 @@
 
 #include "IDictionary.h"
 #include "ArraySequence.h"
+#include "Hash.h"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <stdexcept>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Ключ поиска с заранее посчитанным хэшем (см. Dictionary::prehash): если одно и то же имя
+// ищется несколько раз, строка хэшируется только однажды. Строковые ключи хранятся как
+// string_view, поэтому исходная строка должна жить, пока используется Prehashed
+template <typename K>
+struct Prehashed {
+    K key;
+    size_t hash;
+};
 
-template <typename Key, typename Value>
+// Хэш с is_avalanching уже перемешан, таблица берёт из него биты без дополнительного перемешивания
+template <typename Hash, typename = void>
+struct IsAvalanching : std::false_type {};
+
+template <typename Hash>
+struct IsAvalanching<Hash, std::void_t<typename Hash::is_avalanching>> : std::true_type {};
+
+// Хэш с is_transparent для строковых ключей принимает string_view
+template <typename Key, typename Hash, typename = void>
+struct IsTransparent : std::false_type {};
+
+template <typename Key, typename Hash>
+struct IsTransparent<Key, Hash, std::void_t<typename Hash::is_transparent>> : std::is_same<Key, std::string> {};
+
+// Типы, которыми можно искать без создания ключа: для строковых ключей с прозрачным хэшем -
+// всё, что приводится к string_view
+template <typename Key, typename Hash, typename K>
+using EnableTransparent = std::enable_if_t<IsTransparent<Key, Hash>::value
+                                           && !std::is_same<std::decay_t<K>, Key>::value
+                                           && std::is_convertible<const K&, std::string_view>::value, int>;
+
+// Хэш-таблица с открытой адресацией в стиле SwissTable. Кроме массива ячеек хранится массив
+// управляющих байтов: в байте ячейки лежат младшие 7 бит хэша ключа или признак пустой ячейки.
+// Поиск сравнивает сразу группу из 16 управляющих байтов (одной SSE2-инструкцией), и ключи
+// сравниваются только в ячейках, где совпал фрагмент хэша. Размер таблицы - степень двойки,
+// поэтому вместо деления по модулю используется маска. Пробирование линейное, удаление со
+// сдвигом назад, так что надгробия не нужны.
+// Расширение постепенное: старая и новая таблицы существуют одновременно, и каждая операция
+// изменения переносит в новую не больше migrationBatch ячеек старой.
+// Полный хэш хранится в ячейке, так что при расширении и удалении ключи заново не хэшируются.
+// Хэш-функция задаётся параметром Hash (см. Hash.h), DefaultHash::seeded() защищает от подобранных ключей
+template <typename Key, typename Value, typename Hash = DefaultHash<Key>>
 class Dictionary : public IDictionary<Key, Value> {
 private:
     struct KeyValue {
         Key key;
         Value value;
-        bool isOccupied = false;
+        size_t hash; // Полный хэш ключа
+
+        template <typename K, typename V>
+        KeyValue(K&& key, V&& value, size_t hash)
+            : key(std::forward<K>(key)), value(std::forward<V>(value)), hash(hash) {}
+    };
 
-        KeyValue() = default;
-        KeyValue(const Key& key, const Value& value, bool isOccupied)
-            : key(key), value(value), isOccupied(isOccupied) {}
+    static constexpr size_t groupWidth = 16;
+    static constexpr size_t minCapacity = 16;
+    static constexpr size_t migrationBatch = 64; // Ячеек старой таблицы, переносимых за одну операцию
+    static constexpr uint8_t empty = 0x80; // У заполненных ячеек старший бит всегда 0
+    static constexpr uint8_t moved = 0xFE; // Надгробие, бывает только в старой таблице во время переноса
+
+    struct Table {
+        uint8_t* ctrl = nullptr; // capacity байтов и копия первых groupWidth - 1 в конце, чтобы группа читалась без переноса
+        KeyValue* slots = nullptr; // Сырая память, ячейки конструируются только при вставке
+        size_t capacity = 0;
+        size_t mask = 0;
+        size_t size = 0;
     };
 
-    ArraySequence<KeyValue>* table;
-    size_t current_size;
-    size_t capacity_;
+    Hash hasher;
+    Table table; // Основная таблица, все вставки идут в неё
+    Table old; // Таблица, из которой идёт перенос (ctrl == nullptr, если переноса нет)
+    size_t migrated = 0; // Сколько ячеек old уже просмотрено
+    double maxLoad = 0.875; // Максимальная заполненность
+    size_t reserved = 0; // Ниже этого размера таблица автоматически не сжимается
+
+    // Сторонние хэши (например, std::hash для целых - тождественная функция) перемешиваем,
+    // чтобы и фрагмент, и номер домашней ячейки зависели от всего ключа
+    static size_t finish(size_t h) {
+        if constexpr (IsAvalanching<Hash>::value) {
+            return h;
+        } else {
+            return static_cast<size_t>(hashing::fmix64(h));
+        }
+    }
 
     size_t hash(const Key& key) const {
-        //std::cout << "Hash function" << std::endl;
-        //std::cout << "Length: " << capacity_ << std::endl;
-        return std::hash<Key>{}(key) % capacity_;
+        return finish(hasher(key));
+    }
+
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    size_t hash(const K& key) const {
+        return finish(hasher(std::string_view(key)));
+    }
+
+    static uint8_t fragment(size_t hash) {
+        return static_cast<uint8_t>(hash & 0x7F);
+    }
+
+    static size_t home(const Table& t, size_t hash) {
+        return (hash >> 7) & t.mask;
+    }
+
+    static bool isFull(uint8_t control) {
+        return (control & 0x80) == 0;
+    }
+
+    // Битовая маска ячеек группы, управляющий байт которых равен value
+    static uint32_t match(const uint8_t* group, uint8_t value) {
+#if defined(__SSE2__)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+        uint32_t bits = 0;
+        for (size_t i = 0; i < groupWidth; ++i) {
+            bits |= static_cast<uint32_t>(group[i] == value) << i;
+        }
+        return bits;
+#endif
+    }
+
+    static size_t lowestBit(uint32_t bits) {
+        return static_cast<size_t>(__builtin_ctz(bits));
+    }
+
+    static size_t roundCapacity(size_t requested) {
+        size_t capacity = minCapacity;
+        while (capacity < requested) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    static void setCtrl(Table& t, size_t index, uint8_t value) {
+        t.ctrl[index] = value;
+        if (index < groupWidth - 1) {
+            t.ctrl[t.capacity + index] = value;
+        }
+    }
+
+    // Группа пустых байтов, общая для всех ещё не выделенных таблиц: поиск в пустом словаре
+    // идёт обычным путём и сразу заканчивается, а память выделяется только при первой вставке
+    static uint8_t* emptyGroup() {
+        static uint8_t group[groupWidth] = {empty, empty, empty, empty, empty, empty, empty, empty,
+                                            empty, empty, empty, empty, empty, empty, empty, empty};
+        return group;
     }
 
-    void rehash() {
-        size_t old_capacity = capacity_;
-        size_t new_capacity = capacity_ * 2;
-        auto* new_table = new ArraySequence<KeyValue>(new_capacity);
+    static Table unallocated() {
+        Table t;
+        t.ctrl = emptyGroup();
+        return t;
+    }
 
-        for (size_t i = 0; i < new_capacity; ++i) {
-            new_table->append({});
+    static Table allocate(size_t capacity) {
+        if (capacity == 0) {
+            return unallocated();
         }
+        Table t;
+        t.capacity = capacity;
+        t.mask = capacity - 1;
+        t.ctrl = new uint8_t[capacity + groupWidth - 1];
+        std::memset(t.ctrl, empty, capacity + groupWidth - 1);
+        t.slots = std::allocator<KeyValue>().allocate(capacity);
+        return t;
+    }
 
-        for (size_t i = 0; i < capacity_; ++i) {
-            if ((*table)[i].isOccupied) {
-                size_t new_index = std::hash<Key>{}((*table)[i].key) % new_capacity;
+    static void destroySlots(Table& t) {
+        for (size_t i = 0; i < t.capacity; ++i) {
+            if (isFull(t.ctrl[i])) {
+                t.slots[i].~KeyValue();
+            }
+        }
+        t.size = 0;
+    }
+
+    static void release(Table& t) {
+        if (t.capacity != 0) {
+            destroySlots(t);
+            delete[] t.ctrl;
+            std::allocator<KeyValue>().deallocate(t.slots, t.capacity);
+        }
+        t = Table();
+    }
 
-                while ((*new_table)[new_index].isOccupied) {
-                    new_index = (new_index + 1) % new_capacity;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Единственный проход по цепочке: индекс ячейки с ключом или npos
+    template <typename K>
+    static size_t findIndex(const Table& t, const K& key, size_t hash) {
+        uint8_t h2 = fragment(hash);
+        size_t position = home(t, hash);
+        while (true) { // Заполненность не выше 7/8, поэтому пустая ячейка всегда найдётся
+            const uint8_t* group = t.ctrl + position;
+            uint32_t empties = match(group, empty);
+            uint32_t candidates = match(group, h2);
+            if (empties) {
+                candidates &= (empties & (0u - empties)) - 1; // Цепочка ключа кончается на первой пустой ячейке
+            }
+            while (candidates) {
+                size_t index = (position + lowestBit(candidates)) & t.mask;
+                const KeyValue& entry = t.slots[index];
+                if (entry.hash == hash && entry.key == key) { // Ключи сравниваются, только если совпал весь хэш
+                    return index;
                 }
+                candidates &= candidates - 1;
+            }
+            if (empties) {
+                return npos;
+            }
+            position = (position + groupWidth) & t.mask;
+        }
+    }
+
+    template <typename K>
+    KeyValue* lookup(const K& key, size_t hash) const {
+        size_t index = findIndex(table, key, hash);
+        if (index != npos) {
+            return &table.slots[index];
+        }
+        if (old.ctrl) {
+            index = findIndex(old, key, hash);
+            if (index != npos) {
+                return &old.slots[index];
+            }
+        }
+        return nullptr;
+    }
 
-                (*new_table)[new_index] = (*table)[i];
+    static size_t firstEmpty(const Table& t, size_t hash) {
+        size_t position = home(t, hash);
+        while (true) {
+            uint32_t empties = match(t.ctrl + position, empty);
+            if (empties) {
+                return (position + lowestBit(empties)) & t.mask;
             }
+            position = (position + groupWidth) & t.mask;
         }
+    }
 
-        //std::cout << "Rehashing: Old capacity: " << old_capacity
-        //          << " New capacity: " << new_capacity << std::endl;
+    template <typename K, typename V>
+    KeyValue& place(size_t hash, K&& key, V&& value) {
+        size_t index = firstEmpty(table, hash);
+        new (&table.slots[index]) KeyValue(std::forward<K>(key), std::forward<V>(value), hash);
+        setCtrl(table, index, fragment(hash));
+        ++table.size;
+        return table.slots[index];
+    }
 
-        delete table;  // Удаляем старый массив
-        table = new_table;
-        capacity_ = new_capacity;
+    // Расстояние от ячейки from до ячейки to при движении вперёд по кругу
+    static size_t distance(const Table& t, size_t from, size_t to) {
+        return (to - from) & t.mask;
     }
 
-public:
-    Dictionary() : current_size(0), capacity_(16) {
-        table = new ArraySequence<KeyValue>(capacity_);
-        for (size_t i = 0; i < capacity_; ++i) {
-            table->append({});
+    // Переносит следующую порцию ячеек старой таблицы. На их месте остаются надгробия,
+    // чтобы цепочки ещё не перенесённых ключей не рвались
+    void migrateStep() {
+        if (!old.ctrl) {
+            return;
+        }
+        size_t end = migrated + migrationBatch < old.capacity ? migrated + migrationBatch : old.capacity;
+        for (; migrated < end && old.size != 0; ++migrated) {
+            if (isFull(old.ctrl[migrated])) {
+                KeyValue& entry = old.slots[migrated];
+                place(entry.hash, std::move(entry.key), std::move(entry.value));
+                entry.~KeyValue();
+                setCtrl(old, migrated, moved);
+                --old.size;
+            }
+        }
+        if (old.size == 0) {
+            release(old);
         }
     }
 
-    explicit Dictionary(size_t initial_capacity)
-        : current_size(0), capacity_(initial_capacity) {
-        table = new ArraySequence<KeyValue>(capacity_);
-        for (size_t i = 0; i < capacity_; ++i) {
-            table->append({});
+    // Сколько элементов помещается в таблицу размера capacity (хотя бы одна ячейка остаётся пустой)
+    size_t limit(size_t capacity) const {
+        if (capacity == 0) {
+            return 0;
         }
+        size_t fits = static_cast<size_t>(static_cast<double>(capacity) * maxLoad);
+        return fits < capacity ? fits : capacity - 1;
     }
 
-    ~Dictionary() {
-        delete table;
+    // Наименьший размер таблицы, в который n элементов помещаются без расширения
+    size_t capacityFor(size_t n) const {
+        if (n == 0) {
+            return 0;
+        }
+        size_t capacity = minCapacity;
+        while (limit(capacity) < n) {
+            capacity <<= 1;
+        }
+        return capacity;
     }
 
-    size_t count() const override {
-        return current_size;
+    void finishMigration() {
+        while (old.ctrl) {
+            migrateStep();
+        }
     }
 
-    size_t capacity() const override {
-        return capacity_;
+    // Начинает постепенный перенос в таблицу размера new_capacity
+    void resize(size_t new_capacity) {
+        finishMigration(); // Предыдущий перенос к этому моменту почти всегда уже закончен
+        if (table.size == 0) { // Переносить нечего
+            release(table);
+            table = allocate(new_capacity);
+            return;
+        }
+        old = table;
+        table = allocate(new_capacity);
+        migrated = 0;
+        migrateStep();
     }
 
-    bool contains_key(const Key& key) const override {
-        size_t index = hash(key);
-        size_t start_index = index;
+    // Таблица вдвое меньше, если заполнено меньше четверти допустимого. Порог с запасом,
+    // чтобы чередование вставок и удалений на границе не вызывало перестройки туда и обратно
+    void shrinkIfSparse() {
+        if (!old.ctrl && table.capacity > minCapacity && table.capacity > reserved
+            && count() < limit(table.capacity) / 4) {
+            resize(table.capacity / 2);
+        }
+    }
 
-        do {
-            if (!(*table)[index].isOccupied) {
-                return false;
+    template <typename K, typename V>
+    KeyValue& insert(K&& key, V&& value) {
+        migrateStep();
+        size_t h = hash(key);
+        if (KeyValue* found = lookup(key, h)) {
+            found->value = std::forward<V>(value);
+            return *found;
+        }
+        if (count() + 1 > limit(table.capacity)) {
+            resize(table.capacity == 0 ? minCapacity : table.capacity * 2);
+        }
+        return place(h, std::forward<K>(key), std::forward<V>(value));
+    }
+
+    template <typename K>
+    void erase(const K& key, size_t h) {
+        migrateStep();
+        size_t index = findIndex(table, key, h);
+        if (index == npos) {
+            index = old.ctrl ? findIndex(old, key, h) : npos;
+            if (index == npos) {
+                throw std::runtime_error("Key not found");
+            }
+            // В старой таблице ничего не сдвигаем, чтобы не мешать переносу
+            old.slots[index].~KeyValue();
+            setCtrl(old, index, moved);
+            if (--old.size == 0) {
+                release(old);
             }
-            if ((*table)[index].key == key) {
-                return true;
+            shrinkIfSparse();
+            return;
+        }
+
+        // Удаление со сдвигом назад: элемент цепочки за дыркой переносится в неё, если дырка
+        // лежит между его домашней ячейкой и текущей позицией. Цепочки остаются непрерывными
+        // без надгробий, а длина проб после удалений не растёт
+        size_t hole = index;
+        table.slots[hole].~KeyValue();
+        size_t next = (hole + 1) & table.mask;
+        while (table.ctrl[next] != empty) {
+            if (distance(table, home(table, table.slots[next].hash), next) >= distance(table, hole, next)) {
+                new (&table.slots[hole]) KeyValue(std::move(table.slots[next]));
+                table.slots[next].~KeyValue();
+                setCtrl(table, hole, table.ctrl[next]);
+                hole = next;
             }
-            index = (index + 1) % capacity_;
-        } while (index != start_index);
+            next = (next + 1) & table.mask;
+        }
+        setCtrl(table, hole, empty);
+        --table.size;
+        shrinkIfSparse();
+    }
 
-        return false;
+    static void prefetch(const void* address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#endif
     }
 
-    void add(const Key& key, const Value& value) override {
-        if (current_size >= capacity_ / 2) {
-            //std::cout << "Rehashing triggered. Current size: " << current_size
-             //         << " Capacity: " << capacity_ << std::endl;
-            rehash();
+    // Число элементов диапазона, если его можно узнать без прохода (иначе 0)
+    template <typename It>
+    static size_t rangeSize(It first, It last) {
+        if constexpr (std::is_base_of<std::forward_iterator_tag,
+                                      typename std::iterator_traits<It>::iterator_category>::value) {
+            return static_cast<size_t>(std::distance(first, last));
+        } else {
+            return 0;
         }
+    }
 
-        size_t index = hash(key);
-        while ((*table)[index].isOccupied) {
-            if ((*table)[index].key == key) {
-                (*table)[index].value = value;
-                return;
+    // Итератор только по заполненным ячейкам (сначала основная таблица, затем старая)
+    template <typename Entry>
+    class Iterator {
+    private:
+        const Table* current;
+        const Table* next;
+        size_t index;
+
+        void skipEmpty() {
+            while (current) {
+                while (index < current->capacity && !isFull(current->ctrl[index])) {
+                    ++index;
+                }
+                if (index < current->capacity) {
+                    return;
+                }
+                current = next;
+                next = nullptr;
+                index = 0;
             }
-            index = (index + 1) % capacity_;
         }
 
-        (*table)[index] = {key, value, true};
-        ++current_size;
-        //std::cout << "Added key: " << key << " at index: " << index
-        //          << " after " << probeCount << " probes" << std::endl;
+    public:
+        Iterator() : current(nullptr), next(nullptr), index(0) {}
+
+        Iterator(const Table* first, const Table* second)
+            : current(first), next(second->ctrl ? second : nullptr), index(0) {
+            skipEmpty();
+        }
+
+        Entry& operator*() const {
+            return current->slots[index];
+        }
+
+        Entry* operator->() const {
+            return &current->slots[index];
+        }
+
+        Iterator& operator++() {
+            ++index;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return current == other.current && index == other.index;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+public:
+    // Память под таблицу выделяется при первой вставке
+    Dictionary() : table(unallocated()) {}
+
+    explicit Dictionary(size_t initial_capacity, Hash hasher = Hash())
+        : hasher(std::move(hasher)), table(allocate(roundCapacity(initial_capacity))), reserved(table.capacity) {}
+
+    explicit Dictionary(Hash hasher) : hasher(std::move(hasher)), table(unallocated()) {}
+
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+    ~Dictionary() {
+        release(old);
+        release(table);
+    }
+
+    size_t count() const override {
+        return table.size + old.size;
+    }
+
+    size_t capacity() const override {
+        return table.capacity;
+    }
+
+    double maxLoadFactor() const {
+        return maxLoad;
+    }
+
+    // Допустимая заполненность от 0.25 до 0.95: чем меньше, тем короче цепочки и больше памяти
+    void setMaxLoadFactor(double factor) {
+        if (factor < 0.25 || factor > 0.95) {
+            throw std::invalid_argument("Max load factor must be between 0.25 and 0.95");
+        }
+        maxLoad = factor;
+        if (count() > limit(table.capacity)) {
+            finishMigration();
+            resize(capacityFor(count()));
+            finishMigration();
+        }
+    }
+
+    // Выделяет место под n элементов сразу, чтобы вставки до этого размера не вызывали
+    // перестроек. Таблица не сжимается автоматически ниже зарезервированного размера
+    void reserve(size_t n) {
+        reserved = capacityFor(n);
+        if (reserved > table.capacity) {
+            resize(reserved);
+            finishMigration();
+        }
+    }
+
+    // Сжимает таблицу до размера, достаточного для текущих элементов, и снимает резерв
+    void shrink_to_fit() {
+        reserved = 0;
+        size_t fitting = capacityFor(count());
+        if (fitting < table.capacity) {
+            resize(fitting);
+        }
+        finishMigration();
+    }
+
+    // Идёт ли сейчас перенос из старой таблицы
+    bool rehashing() const {
+        return old.ctrl != nullptr;
+    }
+
+    bool contains_key(const Key& key) const override {
+        return lookup(key, hash(key)) != nullptr;
+    }
+
+    // Указатель на значение или nullptr, если ключа нет. В отличие от пары contains_key + get,
+    // ключ хэшируется и ищется только один раз, а промах не выбрасывает исключение
+    Value* find(const Key& key) override {
+        KeyValue* entry = lookup(key, hash(key));
+        return entry ? &entry->value : nullptr;
+    }
+
+    const Value* find(const Key& key) const override {
+        const KeyValue* entry = lookup(key, hash(key));
+        return entry ? &entry->value : nullptr;
+    }
+
+    void add(const Key& key, const Value& value) override {
+        insert(key, value);
+    }
+
+    void add(Key&& key, Value&& value) { // Ключ и значение перемещаются в таблицу без копирования
+        insert(std::move(key), std::move(value));
     }
 
     void remove(const Key& key) override {
-        size_t index = hash(key);
-        size_t start_index = index;
+        erase(key, hash(key));
+    }
 
-        do {
-            if (!(*table)[index].isOccupied) {
-                throw std::runtime_error("Key not found");
-            }
-            if ((*table)[index].key == key) {
-                (*table)[index].isOccupied = false;
-                --current_size;
-                return;
+    // Добавляет пары (first, second) из диапазона. Таблица расширяется один раз заранее,
+    // поэтому вставки не проверяют заполненность и не вызывают перестроек
+    template <typename It>
+    void add_range(It first, It last) {
+        size_t incoming = rangeSize(first, last);
+        if (incoming != 0 && count() + incoming > limit(table.capacity)) {
+            size_t saved = reserved;
+            reserve(count() + incoming);
+            reserved = saved; // Резерв под разовую загрузку не мешает потом сжиматься
+        }
+        finishMigration();
+        for (; first != last; ++first) {
+            insert(first->first, first->second);
+        }
+    }
+
+    // Заменяет содержимое словаря парами из диапазона
+    template <typename It>
+    void build_from(It first, It last) {
+        clear();
+        add_range(first, last);
+    }
+
+    // Пакетный поиск: out[i] - указатель на значение keys[i] или nullptr. Хэши считаются
+    // на distance ключей вперёд, и нужные группы заранее запрашиваются в кэш, так что промахи
+    // кэша по разным ключам перекрываются. Возвращает число найденных ключей
+    size_t get_many(const Key* keys, size_t n, Value** out) {
+        constexpr size_t distance = 16; // Степень двойки - индекс в кольце хэшей берётся по маске
+        size_t hashes[distance];
+        auto request = [&](size_t i) {
+            size_t h = hash(keys[i]);
+            hashes[i & (distance - 1)] = h;
+            size_t position = home(table, h);
+            prefetch(table.ctrl + position);
+            prefetch(table.slots + position);
+        };
+        for (size_t i = 0; i < n && i < distance; ++i) {
+            request(i);
+        }
+        size_t found = 0;
+        for (size_t i = 0; i < n; ++i) {
+            size_t h = hashes[i & (distance - 1)];
+            if (i + distance < n) {
+                request(i + distance);
             }
-            index = (index + 1) % capacity_;
-        } while (index != start_index);
+            KeyValue* entry = lookup(keys[i], h);
+            out[i] = entry ? &entry->value : nullptr;
+            found += entry != nullptr;
+        }
+        return found;
+    }
 
-        throw std::runtime_error("Key not found");
+    size_t get_many(const ArraySequence<Key>& keys, ArraySequence<Value*>& out) {
+        size_t n = static_cast<size_t>(keys.getLength());
+        out.clear();
+        if (n == 0) {
+            return 0;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            out.append(nullptr);
+        }
+        return get_many(&keys.get(0), n, &out.get(0)); // ArraySequence хранит элементы подряд
     }
 
     Value& get(const Key& key) override {
-        size_t index = hash(key);
-        size_t start_index = index;
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
 
-        do {
-            if (!(*table)[index].isOccupied) {
-                throw std::runtime_error("Key not found");
-            }
-            if ((*table)[index].key == key) {
-                return (*table)[index].value;
-            }
-            index = (index + 1) % capacity_;
-        } while (index != start_index);
+    const Value& get(const Key& key) const override {
+        const Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
 
-        throw std::runtime_error("Key not found");
+    // Поиск без создания ключа: dict.find(std::string_view(...)) для Dictionary<std::string, ...>
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    Value* find(const K& key) {
+        return find(prehash(key));
     }
 
-    const Value& get(const Key& key) const override {
-        size_t index = hash(key);
-        size_t start_index = index;
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    const Value* find(const K& key) const {
+        return find(prehash(key));
+    }
 
-        do {
-            if (!(*table)[index].isOccupied) {
-                throw std::runtime_error("Key not found");
-            }
-            if ((*table)[index].key == key) {
-                return (*table)[index].value;
-            }
-            index = (index + 1) % capacity_;
-        } while (index != start_index);
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    bool contains_key(const K& key) const {
+        return find(key) != nullptr;
+    }
 
-        throw std::runtime_error("Key not found");
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    Value& get(const K& key) {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    void remove(const K& key) {
+        erase(key, hash(key));
+    }
+
+    using LookupKey = std::conditional_t<IsTransparent<Key, Hash>::value, std::string_view, Key>;
+
+    // Ключ вместе с хэшем для повторных поисков
+    Prehashed<LookupKey> prehash(const LookupKey& key) const {
+        return {key, hash(key)};
+    }
+
+    template <typename K>
+    Value* find(const Prehashed<K>& key) {
+        KeyValue* entry = lookup(key.key, key.hash);
+        return entry ? &entry->value : nullptr;
+    }
+
+    template <typename K>
+    const Value* find(const Prehashed<K>& key) const {
+        const KeyValue* entry = lookup(key.key, key.hash);
+        return entry ? &entry->value : nullptr;
     }
 
     Value& operator[](const Key& key) override {
-        size_t index = hash(key);
-        while ((*table)[index].isOccupied) {
-            if ((*table)[index].key == key) {
-                return (*table)[index].value;
-            }
-            index = (index + 1) % capacity_;
+        if (KeyValue* entry = lookup(key, hash(key))) {
+            return entry->value;
         }
+        return insert(key, Value{}).value;
+    }
 
-        if (current_size >= capacity_ / 2) {
-            rehash();
-            index = hash(key);
+    // Освобождает и память: таблица возвращается к зарезервированному размеру
+    void clear() override {
+        release(old);
+        if (table.capacity == reserved) {
+            if (table.capacity != 0) {
+                destroySlots(table);
+                std::memset(table.ctrl, empty, table.capacity + groupWidth - 1);
+            }
+            return;
         }
+        release(table);
+        table = allocate(reserved);
+    }
+
+    using iterator = Iterator<KeyValue>;
+    using const_iterator = Iterator<const KeyValue>;
 
-        (*table)[index] = {key, Value{}, true};
-        ++current_size;
-        return (*table)[index].value;
+    iterator begin() {
+        return iterator(&table, &old);
     }
 
-    void clear() override {
-        for (size_t i = 0; i < capacity_; ++i) {
-            (*table)[i].isOccupied = false;
-        }
-        current_size = 0;
+    iterator end() {
+        return iterator();
     }
 
-    auto begin() {
-        return table->begin();
+    const_iterator begin() const {
+        return const_iterator(&table, &old);
     }
 
-    auto end() {
-        return table->end();
+    const_iterator end() const {
+        return const_iterator();
     }
 
-    auto begin() const {
-        return table->begin();
+    // Вызывает visitor(key, value) для каждого элемента, без выделения памяти и повторных поисков.
+    // Менять набор ключей во время обхода нельзя
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) {
+        for (KeyValue& entry : *this) {
+            visitor(static_cast<const Key&>(entry.key), entry.value);
+        }
     }
 
-    auto end() const {
-        return table->end();
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const {
+        for (const KeyValue& entry : *this) {
+            visitor(entry.key, entry.value);
+        }
     }
 
     ArraySequence<Key> keys() const {
         ArraySequence<Key> keyList;
-        for (const auto& entry : *table) {
-            if (entry.isOccupied) {
-                keyList.append(entry.key);
-            }
+        for (const auto& entry : *this) {
+            keyList.append(entry.key);
         }
         return keyList;
     }
@@ -2,6 +2,7 @@
 #define SEQUENCES_DYNAMICARRAY_H
 
 #include <stdexcept>
+#include <utility>
 
 template<class T>
 class DynamicArray {
@@ -15,7 +16,7 @@ private:
         this->capacity *= 2;
         T *newArray = new T[this->capacity];
         for (int i = 0; i < this->length; i++) {
-            newArray[i] = this->array[i];
+            newArray[i] = std::move(this->array[i]); // Старый массив сразу удаляется, копировать незачем
         }
         delete[] this->array;
         this->array = newArray;
@@ -64,7 +65,7 @@ public:
         if (this->length == this->capacity) {
             this->resize();
         }
-        this->array[this->length] = value;
+        this->array[this->length] = std::move(value);
         this->length++;
     }
 
@@ -73,9 +74,9 @@ public:
             this->resize();
         }
         for (int i = this->length; i > 0; i--) {
-            this->array[i] = this->array[i - 1];
+            this->array[i] = std::move(this->array[i - 1]);
         }
-        this->array[0] = value;
+        this->array[0] = std::move(value);
         this->length++;
     }
 
@@ -87,9 +88,9 @@ public:
             this->resize();
         }
         for (int i = this->length; i > index; i--) {
-            this->array[i] = this->array[i - 1];
+            this->array[i] = std::move(this->array[i - 1]);
         }
-        this->array[index] = value;
+        this->array[index] = std::move(value);
         this->length++;
     }
 
@@ -97,7 +98,7 @@ public:
         if (index < 0 || index >= this->length) {
             throw std::out_of_range("Index out of range");
         }
-        this->array[index] = value;
+        this->array[index] = std::move(value);
     }
 
     void clear() {
@@ -111,9 +112,9 @@ public:
         if (index < 0 || index >= this->length) {
             throw std::out_of_range("Index out of range");
         }
-        T value = this->array[index];
+        T value = std::move(this->array[index]);
         for (int i = index; i < this->length - 1; i++) {
-            this->array[i] = this->array[i + 1];
+            this->array[i] = std::move(this->array[i + 1]);
         }
         this->length--;
         return value;
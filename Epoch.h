@@ -0,0 +1,209 @@
+#ifndef L3_EPOCH_H
+#define L3_EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+// Эпохальное освобождение памяти (epoch-based reclamation) для структур, которые читаются без блокировок.
+// Читатель открывает Guard: поток записывает текущую глобальную эпоху в свою запись (отдельная кэш-линия),
+// на выходе - ноль. Писатель, исключив объект из структуры, передаёт его в retire; объект удаляется,
+// когда каждый поток внутри Guard вошёл в эпоху позже той, в которой объект был исключён, -
+// такой поток уже не может получить на него указатель.
+// Чтение не пишет ни в какие общие кэш-линии, общая эпоха меняется только при сборке мусора писателями
+namespace reclamation {
+
+struct alignas(64) Record { // Выравнивание: запись пишет только её поток
+    std::atomic<uint64_t> epoch{0}; // Эпоха входа в Guard, 0 - поток вне Guard
+    std::atomic<bool> owned{true}; // Занята ли запись живым потоком
+    unsigned depth = 0; // Вложенность Guard, меняет только владелец
+    Record* next = nullptr; // Реестр записей только растёт
+};
+
+class Domain {
+private:
+    struct Retired {
+        void* object;
+        void (*destroy)(void*);
+        uint64_t epoch; // Эпоха, в которой объект исключён из структуры
+        Retired* next;
+    };
+
+    static constexpr size_t collectThreshold = 64;
+
+    std::atomic<uint64_t> global{1};
+    std::atomic<Record*> records{nullptr};
+    std::mutex limboMutex;
+    Retired* limbo = nullptr; // Исключённые, но ещё не удалённые объекты
+    size_t limboSize = 0;
+    size_t nextCollect = collectThreshold;
+
+    // Запись потока освобождается при его завершении и достаётся следующему новому потоку
+    struct Owner {
+        Record* record = nullptr;
+
+        ~Owner() {
+            if (record) {
+                record->owned.store(false);
+            }
+        }
+    };
+
+    Record* acquire() {
+        for (Record* record = records.load(); record; record = record->next) {
+            bool expected = false;
+            if (!record->owned.load(std::memory_order_relaxed) && record->owned.compare_exchange_strong(expected, true)) {
+                return record;
+            }
+        }
+        Record* record = new Record;
+        record->next = records.load();
+        while (!records.compare_exchange_weak(record->next, record)) {
+        }
+        return record;
+    }
+
+    // Вызывается под limboMutex. Продвигает эпоху и отделяет объекты, которые уже никто не читает
+    Retired* collect() {
+        global.fetch_add(1);
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (Record* record = records.load(); record; record = record->next) {
+            uint64_t entered = record->epoch.load();
+            if (entered != 0 && entered < oldest) {
+                oldest = entered;
+            }
+        }
+        Retired* ready = nullptr;
+        Retired** link = &limbo;
+        while (*link) {
+            Retired* item = *link;
+            if (item->epoch < oldest) {
+                *link = item->next;
+                item->next = ready;
+                ready = item;
+                --limboSize;
+            } else {
+                link = &item->next;
+            }
+        }
+        // Пока долгий читатель держит старую эпоху, не пересобираем список на каждом retire
+        nextCollect = limboSize * 2 > collectThreshold ? limboSize * 2 : collectThreshold;
+        return ready;
+    }
+
+    static void destroyAll(Retired* items) {
+        while (items) {
+            Retired* next = items->next;
+            items->destroy(items->object);
+            delete items;
+            items = next;
+        }
+    }
+
+public:
+    Domain() = default;
+    Domain(const Domain&) = delete;
+    Domain& operator=(const Domain&) = delete;
+
+    // К моменту уничтожения статических объектов читателей уже нет
+    ~Domain() {
+        destroyAll(limbo);
+        Record* record = records.load();
+        while (record) {
+            Record* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    Record* local() {
+        thread_local Owner owner;
+        if (!owner.record) {
+            owner.record = acquire();
+        }
+        return owner.record;
+    }
+
+    void enter(Record* record) {
+        if (record->depth++ == 0) {
+            record->epoch.store(global.load());
+        }
+    }
+
+    void leave(Record* record) {
+        if (--record->depth == 0) {
+            record->epoch.store(0);
+        }
+    }
+
+    // Объект уже недостижим для новых читателей; destroy вызывается, когда его не читает никто
+    void retire(void* object, void (*destroy)(void*)) {
+        Retired* ready = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(limboMutex);
+            limbo = new Retired{object, destroy, global.load(), limbo};
+            if (++limboSize >= nextCollect) {
+                ready = collect();
+            }
+        }
+        destroyAll(ready);
+    }
+
+    // Удаляет всё, что уже можно удалить, не дожидаясь накопления порога
+    void reclaim() {
+        Retired* ready;
+        {
+            std::lock_guard<std::mutex> lock(limboMutex);
+            ready = collect();
+        }
+        destroyAll(ready);
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(limboMutex);
+        return limboSize;
+    }
+};
+
+inline Domain& domain() {
+    static Domain instance;
+    return instance;
+}
+
+// Критическая секция читателя: пока Guard жив, объекты, прочитанные из структуры, не удаляются.
+// Может быть вложенным
+class Guard {
+private:
+    Record* record;
+
+public:
+    Guard() : record(domain().local()) {
+        domain().enter(record);
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+    ~Guard() {
+        domain().leave(record);
+    }
+};
+
+template <typename T>
+void retire(T* object) {
+    domain().retire(object, [](void* pointer) { delete static_cast<T*>(pointer); });
+}
+
+inline void reclaim() {
+    domain().reclaim();
+}
+
+// Сколько исключённых объектов ещё ждут удаления
+inline size_t pending() {
+    return domain().pending();
+}
+
+} // namespace reclamation
+
+#endif //L3_EPOCH_H
@@ -0,0 +1,171 @@
+#ifndef L3_HASH_H
+#define L3_HASH_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Хэш-функции для Dictionary. Результат DefaultHash уже хорошо перемешан (is_avalanching),
+// поэтому таблица может брать из него биты напрямую. Ненулевой seed делает хэши
+// непредсказуемыми снаружи: подобрать ключи, которые попадут в одну цепочку, без знания seed нельзя
+namespace hashing {
+
+// Финализатор MurmurHash3: каждый бит входа влияет на все биты результата
+inline uint64_t fmix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Полное 128-битное произведение, свёрнутое в 64 бита
+inline void multiply128(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t ha = a >> 32, la = static_cast<uint32_t>(a);
+    uint64_t hb = b >> 32, lb = static_cast<uint32_t>(b);
+    uint64_t high = ha * hb, mid0 = ha * lb, mid1 = hb * la, low = la * lb;
+    uint64_t t = low + (mid0 << 32);
+    uint64_t carry = t < low;
+    uint64_t lo = t + (mid1 << 32);
+    carry += lo < t;
+    a = lo;
+    b = high + (mid0 >> 32) + (mid1 >> 32) + carry;
+#endif
+}
+
+inline uint64_t mum(uint64_t a, uint64_t b) {
+    multiply128(a, b);
+    return a ^ b;
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Хэш строки в духе wyhash: по 16-48 байт за шаг через 128-битные умножения
+inline uint64_t hashBytes(const void* data, size_t length, uint64_t seed) {
+    const uint64_t s0 = 0xa0761d6478bd642fULL, s1 = 0xe7037ed1a0b428dbULL;
+    const uint64_t s2 = 0x8ebc6af09c88c6e3ULL, s3 = 0x589965cc75374cc3ULL;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= mum(seed ^ s0, s1);
+    uint64_t a, b;
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t shift = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + shift);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+        } else if (length > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t rest = length;
+        if (rest > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = mum(read64(p) ^ s1, read64(p + 8) ^ seed);
+                seed1 = mum(read64(p + 16) ^ s2, read64(p + 24) ^ seed1);
+                seed2 = mum(read64(p + 32) ^ s3, read64(p + 40) ^ seed2);
+                p += 48;
+                rest -= 48;
+            } while (rest > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (rest > 16) {
+            seed = mum(read64(p) ^ s1, read64(p + 8) ^ seed);
+            p += 16;
+            rest -= 16;
+        }
+        a = read64(p + rest - 16);
+        b = read64(p + rest - 8);
+    }
+    a ^= s1;
+    b ^= seed;
+    multiply128(a, b);
+    return mum(a ^ s0 ^ length, b ^ s1);
+}
+
+// Случайный seed, общий для процесса (вычисляется один раз)
+inline uint64_t processSeed() {
+    static const uint64_t seed = [] {
+        std::random_device device;
+        uint64_t value = (static_cast<uint64_t>(device()) << 32) ^ device();
+        value ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        return fmix64(value);
+    }();
+    return seed;
+}
+
+} // namespace hashing
+
+// Хэш по умолчанию: финализатор для целых чисел, перечислений и указателей,
+// для остальных типов - перемешанный std::hash
+template <typename Key>
+class DefaultHash {
+private:
+    uint64_t seed;
+
+public:
+    using is_avalanching = void;
+
+    explicit DefaultHash(uint64_t seed = 0) : seed(seed) {}
+
+    // Хэш со случайным seed процесса - для ключей, которые может подобрать злоумышленник
+    static DefaultHash seeded() {
+        return DefaultHash(hashing::processSeed());
+    }
+
+    size_t operator()(const Key& key) const {
+        if constexpr (std::is_integral<Key>::value || std::is_enum<Key>::value) {
+            return static_cast<size_t>(hashing::fmix64(static_cast<uint64_t>(key) ^ seed));
+        } else if constexpr (std::is_pointer<Key>::value) {
+            return static_cast<size_t>(hashing::fmix64(reinterpret_cast<uintptr_t>(key) ^ seed));
+        } else {
+            return static_cast<size_t>(hashing::fmix64(std::hash<Key>{}(key) ^ seed));
+        }
+    }
+};
+
+// Для строк хэш считается по байтам и принимает string_view, так что искать можно без создания std::string
+template <>
+class DefaultHash<std::string> {
+private:
+    uint64_t seed;
+
+public:
+    using is_avalanching = void;
+    using is_transparent = void;
+
+    explicit DefaultHash(uint64_t seed = 0) : seed(seed) {}
+
+    static DefaultHash seeded() {
+        return DefaultHash(hashing::processSeed());
+    }
+
+    size_t operator()(std::string_view key) const {
+        return static_cast<size_t>(hashing::hashBytes(key.data(), key.size(), seed));
+    }
+};
+
+#endif //L3_HASH_H
@@ -0,0 +1,27 @@
+#ifndef L3_IASYNCREADER_H
+#define L3_IASYNCREADER_H
+
+#include <cstdint>
+#include <functional>
+#include <sys/types.h>
+
+// Интерфейс асинхронного чтения файлов. Запросы копятся и отправляются пачкой (submit),
+// обработчики завершения вызываются в wait() в вызывающем потоке. Объект не потокобезопасен:
+// им пользуется один поток
+class IAsyncReader {
+public:
+    // Результат чтения: количество прочитанных байт или -errno
+    using Completion = std::function<void(ssize_t result)>;
+
+    // Ставит в очередь чтение length байт файла fd со смещения offset в buffer.
+    // buffer должен оставаться действительным до вызова done
+    virtual void read(int fd, void* buffer, size_t length, uint64_t offset, Completion done) = 0;
+    virtual size_t submit() = 0; // Отправляет накопленные запросы, возвращает их количество
+    virtual void wait() = 0; // Отправляет накопленное и ждёт завершения всех запросов
+    virtual size_t inFlight() const = 0; // Сколько запросов ещё не завершено
+    virtual const char* name() const = 0; // Название реализации
+
+    virtual ~IAsyncReader() = default;
+};
+
+#endif //L3_IASYNCREADER_H
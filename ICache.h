@@ -8,12 +8,42 @@ template <typename Key, typename Value>
 class ICache {
 public:
     virtual void access(const Key& key, const Value& value) = 0; // Добавление элемента в кэш
+    virtual void insert(Key&& key, Value&& value) { // Добавление с перемещением (по умолчанию копирует)
+        access(key, value);
+    }
     virtual bool contains(const Key& key) const = 0; // Проверка наличия элемента в кэше
     virtual Value& get(const Key& key) = 0;
     virtual const Value& get(const Key& key) const = 0; // Получение значения по ключу
+    // Одиночный поиск: указатель на значение (элемент считается использованным) или nullptr при промахе
+    virtual Value* find(const Key& key) = 0;
+    virtual bool try_get(const Key& key, Value& out) { // Копирует значение в out, при промахе возвращает false
+        Value* value = find(key);
+        if (!value) {
+            return false;
+        }
+        out = *value;
+        return true;
+    }
+    // Можно ли вызывать методы кэша из разных потоков без внешней блокировки
+    virtual bool concurrent() const {
+        return false;
+    }
     virtual size_t size() const = 0; // Количество элементов в кэше
     virtual void print() const = 0; // Вывод кэша на экран
     virtual void clear() = 0; // Очистка кэша
+
+    // Возвращает значение по ключу, а при промахе кладёт в кэш результат loader().
+    // Результат перемещается в кэш без копирования. Если кэш отказался хранить значение
+    // (например, оно больше допустимого веса), выбрасывается исключение
+    template <typename Loader>
+    Value& get_or_load(const Key& key, Loader&& loader) {
+        if (Value* value = find(key)) {
+            return *value;
+        }
+        insert(Key(key), loader());
+        return get(key);
+    }
+
     virtual ~ICache() = default; // Виртуальный деструктор (для возможности наследования)
 };
 
@@ -12,6 +12,8 @@ public:
     virtual void remove(const Key& key) = 0; // Удаление элемента
     virtual Value& get(const Key& key) = 0; // Получение значения по ключу
     virtual const Value& get(const Key& key) const = 0; // Получение значения по ключу (константная версия)
+    virtual Value* find(const Key& key) = 0; // Указатель на значение или nullptr, если ключа нет
+    virtual const Value* find(const Key& key) const = 0;
     virtual Value& operator[](const Key& key) = 0; // Оператор доступа по ключу
     virtual void clear() = 0; // Очистка словаря
     virtual ~IDictionary() = default; // Виртуальный деструктор (для возможности наследования)
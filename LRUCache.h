@@ -2,102 +2,340 @@
 #define L3_LRUCACHE_H
 
 #include "ICache.h"
+#include "CacheStats.h"
 #include "Dictionary.h"
-#include "ArraySequence.h"
+#include "RecencyList.h"
+#include "TimingWheel.h"
+#include <chrono>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
-template <typename Key, typename Value>
+// Вес элемента кэша по умолчанию - размер объекта значения
+template <typename Value>
+struct DefaultWeigher {
+    size_t operator()(const Value&) const {
+        return sizeof(Value);
+    }
+};
+
+// Для строк (содержимого файлов) вес - количество байт
+template <>
+struct DefaultWeigher<std::string> {
+    size_t operator()(const std::string& value) const {
+        return value.size();
+    }
+};
+
+// LRU-кэш с двумя ограничениями: на количество элементов (capacity)
+// и на суммарный вес значений (maxWeight, по умолчанию не ограничен).
+// Элементы могут иметь срок жизни (TTL): просроченный элемент удаляется при обращении к нему,
+// а включённый через enableReaper таймерный "сборщик" удаляет и те, к которым больше не обращаются.
+// Stats - политика статистики: NoStats (по умолчанию, ничего не стоит) или AtomicStats
+template <typename Key, typename Value, typename Weigher = DefaultWeigher<Value>, typename Stats = NoStats>
 class LRUCache : public ICache<Key, Value> {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = Clock::duration;
+    using NowFunction = TimePoint (*)(); // Источник текущего времени
+
+    static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+    static constexpr Duration noTtl = Duration::zero(); // Элемент не устаревает
+
 private:
+    struct Entry {
+        Value value;
+        size_t weight = 0; // Вес, вычисленный при вставке
+        TimePoint expiresAt = TimePoint::max(); // Момент устаревания
+        TimePoint timerAt = TimePoint::max(); // Дедлайн таймера этого элемента в колесе (max - таймера нет)
+    };
+
     size_t capacity;
-    Dictionary<Key, Value> dictionary;
-    ArraySequence<Key> usageOrder;
-    Dictionary<Key, size_t> keyPositions;
-    size_t current_size;
+    size_t maxWeight;
+    size_t currentWeight;
+    Weigher weigher;
+    RecencyList<Key, Entry> usageOrder; // Порядок использования, хранит сами значения
+    Dictionary<Key, size_t> positions; // Ключ -> индекс узла в usageOrder
+    Duration defaultTtl;
+    bool hasExpiring; // Был ли хоть один элемент с TTL (иначе время не запрашиваем)
+    TimingWheel<size_t>* reaper; // Таймеры устаревания по индексам узлов (nullptr - сборщик выключен)
+    NowFunction now;
+    mutable Stats statistics;
 
 public:
-    explicit LRUCache(size_t capacity) : capacity(capacity), current_size(0) {}
+    explicit LRUCache(size_t capacity) : LRUCache(capacity, unlimited) {}
 
-    void access(const Key& key, const Value& value) override {
-        if (dictionary.contains_key(key)) {
-            dictionary[key] = value;
-            moveToEnd(key);
-        } else {
-            if (current_size >= capacity) {
-                evict();
-            }
-            dictionary.add(key, value);
-            usageOrder.append(key);
-            keyPositions.add(key, usageOrder.getLength() - 1);  // <--- Запоминаем позицию
-            ++current_size;
+    // Для ограничения только по весу передайте capacity = unlimited
+    LRUCache(size_t capacity, size_t maxWeight, Weigher weigher = Weigher())
+        : capacity(capacity), maxWeight(maxWeight), currentWeight(0), weigher(weigher),
+          defaultTtl(noTtl), hasExpiring(false), reaper(nullptr), now(&Clock::now) {
+        if (capacity != unlimited) { // Размер известен заранее - выделяем всё сразу, без перестроек
+            usageOrder.reserve(capacity);
+            positions.reserve(capacity);
         }
     }
 
+    ~LRUCache() override {
+        delete reaper;
+    }
+
+    // Элемент тяжелее maxWeight в кэш не попадает (старое значение по этому ключу удаляется).
+    // Срок жизни - defaultTtl
+    void access(const Key& key, const Value& value) override {
+        put(key, value, defaultTtl);
+    }
+
+    void access(const Key& key, const Value& value, Duration ttl) { // Со своим сроком жизни
+        put(key, value, ttl);
+    }
+
+    void insert(Key&& key, Value&& value) override { // Ключ и значение перемещаются в кэш
+        put(std::move(key), std::move(value), defaultTtl);
+    }
+
+    void insert(Key&& key, Value&& value, Duration ttl) {
+        put(std::move(key), std::move(value), ttl);
+    }
+
+    // Создаёт значение из аргументов args и перемещает его в кэш
+    template <typename... Args>
+    void emplace(const Key& key, Args&&... args) {
+        put(key, Value(std::forward<Args>(args)...), defaultTtl);
+    }
+
     bool contains(const Key& key) const override {
-        return dictionary.contains_key(key);
+        const size_t* index = positions.find(key);
+        return index && !expired(usageOrder.value(*index));
     }
 
+    // Вес элемента не пересчитывается, если значение изменили через возвращённую ссылку
     Value& get(const Key& key) override {
-        if (!contains(key)) {
+        Value* value = find(key);
+        if (!value) {
             throw std::runtime_error("Key not found");
         }
-        moveToEnd(key);
-        return dictionary.get(key);
+        return *value;
     }
 
     const Value& get(const Key& key) const override {
-        if (!contains(key)) {
+        const size_t* index = positions.find(key);
+        if (!index || expired(usageOrder.value(*index))) {
+            statistics.recordMiss();
             throw std::runtime_error("Key not found");
         }
-        return dictionary.get(key);
+        statistics.recordHit();
+        return usageOrder.value(*index).value;
+    }
+
+    Value* find(const Key& key) override {
+        uint64_t started = Stats::startTimer();
+        Value* result = lookup(key);
+        statistics.recordGetLatency(started);
+        return result;
+    }
+
+    // Удаляет элемент по ключу. Возвращает false, если такого элемента не было
+    bool remove(const Key& key) {
+        size_t* index = positions.find(key);
+        if (!index) {
+            return false;
+        }
+        removeEntry(*index);
+        return true;
     }
 
+    // Количество элементов, включая просроченные, которые ещё не были удалены
     size_t size() const override {
-        return current_size;
+        return usageOrder.size();
+    }
+
+    size_t weight() const { // Суммарный вес элементов в кэше
+        return currentWeight;
+    }
+
+    size_t weightLimit() const {
+        return maxWeight;
+    }
+
+    // Снимок статистики (при политике NoStats - нули, кроме bytesResident)
+    CacheStats stats() const {
+        CacheStats result = statistics.snapshot();
+        result.bytesResident = currentWeight;
+        return result;
+    }
+
+    void setDefaultTtl(Duration ttl) { // Срок жизни для access/insert без явного TTL
+        defaultTtl = ttl;
+    }
+
+    // Подменяет источник времени (например, в тестах). Вызывать до вставки элементов с TTL
+    // и до enableReaper
+    void setClock(NowFunction clock) {
+        now = clock;
+    }
+
+    // Включает сборщик просроченных элементов на колесе таймеров с шагом tick.
+    // После этого каждая вставка и вызов reapExpired удаляют устаревшие элементы
+    void enableReaper(Duration tick = std::chrono::milliseconds(100), size_t wheelSize = 512) {
+        delete reaper;
+        reaper = new TimingWheel<size_t>(tick, wheelSize, now());
+        for (size_t i = usageOrder.front(); i != RecencyList<Key, Entry>::npos; i = usageOrder.next(i)) {
+            Entry& entry = usageOrder.value(i);
+            entry.timerAt = TimePoint::max();
+            scheduleTimer(i, entry);
+        }
+    }
+
+    // Удаляет элементы, срок жизни которых истёк. Возвращает количество удалённых
+    size_t reapExpired() {
+        if (!reaper) {
+            return 0;
+        }
+        size_t removed = 0;
+        TimePoint current = now();
+        reaper->advance(current, [this, &removed, current](size_t index, TimePoint deadline) {
+            Entry& entry = usageOrder.value(index);
+            if (entry.timerAt != deadline) {
+                return; // Устаревший таймер: элемент удалён, узел занят другим ключом или таймер заменён более ранним
+            }
+            entry.timerAt = TimePoint::max();
+            if (entry.expiresAt <= current) {
+                removeEntry(index);
+                statistics.recordExpiration();
+                ++removed;
+            } else {
+                scheduleTimer(index, entry); // Срок продлили после постановки таймера - переносим его
+            }
+        });
+        return removed;
+    }
+
+    // Сколько таймеров лежит в колесе сборщика, включая устаревшие
+    size_t timerCount() const {
+        return reaper ? reaper->size() : 0;
     }
 
     void print() const override {
         std::cout << "Cache contents:\n";
-        for (size_t i = 0; i < usageOrder.getLength(); ++i) {
-            Key key = usageOrder[i];
-            std::cout << "Key: " << key << ", Value: " << dictionary.get(key) << "\n";
+        for (size_t i = usageOrder.front(); i != RecencyList<Key, Entry>::npos; i = usageOrder.next(i)) {
+            std::cout << "Key: " << usageOrder.key(i) << ", Value: " << usageOrder.value(i).value << "\n";
         }
     }
 
     void clear() override {
-        dictionary.clear();
+        positions.clear();
         usageOrder.clear();
-        keyPositions.clear();
-        current_size = 0;
+        currentWeight = 0;
+        if (reaper) {
+            reaper->clear(); // Индексы узлов после очистки недействительны
+        }
     }
 
 private:
-    void evict() {
-        if (usageOrder.getLength() == 0) {
-            return;
+    bool expired(const Entry& entry) const {
+        return hasExpiring && entry.expiresAt != TimePoint::max() && entry.expiresAt <= now();
+    }
+
+    TimePoint deadlineFor(Duration ttl) {
+        if (ttl <= Duration::zero()) {
+            return TimePoint::max();
+        }
+        hasExpiring = true;
+        return now() + ttl;
+    }
+
+    // Ставит таймер элемента, если его нет или он сработает позже срока. Продление срока таймер
+    // не трогает: он перенесётся при срабатывании, поэтому у элемента не копятся лишние таймеры
+    void scheduleTimer(size_t index, Entry& entry) {
+        if (entry.expiresAt < entry.timerAt) {
+            reaper->schedule(index, entry.expiresAt);
+            entry.timerAt = entry.expiresAt;
+        }
+    }
+
+    Value* lookup(const Key& key) {
+        size_t* found = positions.find(key);
+        if (!found) {
+            statistics.recordMiss();
+            return nullptr;
+        }
+        size_t index = *found;
+        if (expired(usageOrder.value(index))) { // Ленивое удаление просроченного элемента
+            removeEntry(index);
+            statistics.recordExpiration();
+            statistics.recordMiss();
+            return nullptr;
         }
-        Key oldest_key = usageOrder.getFirst();
-        dictionary.remove(oldest_key);
-        keyPositions.remove(oldest_key);
-        usageOrder.remove(0);
-        --current_size;
+        usageOrder.moveToBack(index);
+        statistics.recordHit();
+        return &usageOrder.value(index).value;
+    }
+
+    template <typename K, typename V>
+    void put(K&& key, V&& value, Duration ttl) {
+        uint64_t started = Stats::startTimer();
+        store(std::forward<K>(key), std::forward<V>(value), ttl);
+        statistics.recordAccessLatency(started);
+    }
 
-        // Обновляем позиции всех оставшихся элементов
-        for (size_t i = 0; i < usageOrder.getLength(); ++i) {
-            keyPositions[usageOrder[i]] = i;
+    template <typename K, typename V>
+    void store(K&& key, V&& value, Duration ttl) {
+        if (reaper) {
+            reapExpired(); // Колесо продвигается на прошедшие тики, в среднем O(1)
+        }
+        size_t weight = weigher(value);
+        size_t* found = positions.find(key);
+        if (weight > maxWeight) {
+            if (found) {
+                removeEntry(*found);
+            }
+            return;
+        }
+        TimePoint expiresAt = deadlineFor(ttl);
+        size_t index;
+        if (found) {
+            index = *found;
+            Entry& entry = usageOrder.value(index);
+            currentWeight = currentWeight - entry.weight + weight;
+            entry.value = std::forward<V>(value);
+            entry.weight = weight;
+            entry.expiresAt = expiresAt;
+            usageOrder.moveToBack(index);
+            while (currentWeight > maxWeight) { // Новое значение может быть тяжелее старого
+                evict();
+            }
+        } else {
+            if (capacity == 0) {
+                return;
+            }
+            while (!usageOrder.empty() && (usageOrder.size() >= capacity || currentWeight + weight > maxWeight)) {
+                evict();
+            }
+            index = usageOrder.pushBack(std::forward<K>(key), Entry{std::forward<V>(value), weight, expiresAt});
+            positions.add(usageOrder.key(index), index); // Ключ нужен и словарю, поэтому копируется один раз
+            currentWeight += weight;
+            statistics.recordInsertion();
+        }
+        if (reaper) {
+            scheduleTimer(index, usageOrder.value(index));
         }
     }
 
-    void moveToEnd(const Key& key) {
-        size_t index = keyPositions[key];
+    void removeEntry(size_t index) {
+        currentWeight -= usageOrder.value(index).weight;
+        positions.remove(usageOrder.key(index));
         usageOrder.remove(index);
-        usageOrder.append(key);
+    }
 
-        // Обновляем позиции ключей
-        keyPositions[key] = usageOrder.getLength() - 1;
-        for (size_t i = index; i < usageOrder.getLength() - 1; ++i) {
-            keyPositions[usageOrder[i]] = i;
+    void evict() {
+        size_t oldest = usageOrder.front();
+        if (oldest == RecencyList<Key, Entry>::npos) {
+            return;
         }
+        removeEntry(oldest);
+        statistics.recordEviction();
     }
 };
 
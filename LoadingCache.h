@@ -0,0 +1,179 @@
+#ifndef L3_LOADINGCACHE_H
+#define L3_LOADINGCACHE_H
+
+#include "ICache.h"
+#include "Dictionary.h"
+#include "ThreadPool.h"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+// Загружающий кэш поверх любого ICache. При промахе значение получается через loader,
+// причём одновременные промахи по одному ключу объединяются: загрузку выполняет только
+// первый поток, остальные ждут её результат (single-flight). Ошибка загрузчика
+// передаётся всем ожидающим, в кэш ничего не попадает.
+// Если нижележащий кэш потокобезопасен (concurrent()), попадания читают его без общего мьютекса,
+// иначе все обращения к нему идут под мьютексом. Сам загрузчик всегда вызывается без блокировки
+template <typename Key, typename Value>
+class LoadingCache {
+public:
+    using Loader = std::function<Value(const Key&)>;
+
+    static constexpr size_t defaultAsyncThreads = 4;
+
+private:
+    ICache<Key, Value>& cache;
+    Loader loader;
+    bool concurrentCache; // Попадания можно читать без mutex
+    size_t asyncThreads;
+    mutable std::mutex mutex;
+    Dictionary<Key, std::shared_future<Value>> inFlight; // Ключ -> результат текущей загрузки
+    ThreadPool* pool = nullptr; // Фоновые загрузки get_async, создаётся при первой из них
+    std::condition_variable asyncDone;
+    size_t pendingAsync = 0; // Сколько фоновых загрузок ещё не завершилось
+
+    // Выполняет загрузку, которую этот поток зарегистрировал в inFlight
+    Value load(const Key& key, std::promise<Value>& promise) {
+        Value value;
+        try {
+            value = loader(key);
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                inFlight.remove(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cache.access(key, value);
+            inFlight.remove(key); // Следующий промах после вытеснения начнёт новую загрузку
+        }
+        promise.set_value(value);
+        return value;
+    }
+
+    // Попадание без общего мьютекса, если кэш это позволяет
+    bool tryGetUnlocked(const Key& key, Value& value) {
+        if (!concurrentCache) {
+            return false;
+        }
+        return cache.try_get(key, value);
+    }
+
+public:
+    // asyncThreads - сколько потоков выполняют загрузки get_async одновременно
+    LoadingCache(ICache<Key, Value>& cache, Loader loader, size_t asyncThreads = defaultAsyncThreads)
+        : cache(cache), loader(std::move(loader)), concurrentCache(cache.concurrent()), asyncThreads(asyncThreads) {
+        if (asyncThreads == 0) {
+            throw std::invalid_argument("Thread count must be positive");
+        }
+    }
+
+    LoadingCache(const LoadingCache&) = delete;
+    LoadingCache& operator=(const LoadingCache&) = delete;
+
+    // Дожидается фоновых загрузок, так как они обращаются к кэшу и загрузчику
+    ~LoadingCache() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            asyncDone.wait(lock, [this]() { return pendingAsync == 0; });
+        }
+        delete pool;
+    }
+
+    // Возвращает копию значения (ссылка на элемент кэша могла бы устареть после вытеснения)
+    Value get(const Key& key) {
+        Value value;
+        if (tryGetUnlocked(key, value)) {
+            return value;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        // Под мьютексом проверяем снова: загрузка могла завершиться после промаха
+        if (cache.try_get(key, value)) {
+            return value;
+        }
+        if (std::shared_future<Value>* pending = inFlight.find(key)) {
+            std::shared_future<Value> future = *pending;
+            lock.unlock();
+            return future.get(); // Повторно выбрасывает исключение загрузчика
+        }
+        std::promise<Value> promise;
+        inFlight.add(key, promise.get_future().share());
+        lock.unlock();
+        return load(key, promise);
+    }
+
+    // Не блокирует вызывающий поток: при промахе загрузка ставится в очередь пула
+    // из asyncThreads потоков
+    std::shared_future<Value> get_async(const Key& key) {
+        std::shared_ptr<std::promise<Value>> promise = std::make_shared<std::promise<Value>>();
+        Value value;
+        if (tryGetUnlocked(key, value)) {
+            promise->set_value(std::move(value));
+            return promise->get_future().share();
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (cache.try_get(key, value)) {
+            promise->set_value(std::move(value));
+            return promise->get_future().share();
+        }
+        if (std::shared_future<Value>* pending = inFlight.find(key)) {
+            return *pending;
+        }
+        std::shared_future<Value> future = promise->get_future().share();
+        inFlight.add(key, future);
+        ++pendingAsync;
+        if (!pool) {
+            pool = new ThreadPool(asyncThreads);
+        }
+        ThreadPool& workers = *pool;
+        lock.unlock();
+        workers.submit([this, key, promise]() {
+            try {
+                load(key, *promise);
+            } catch (...) {
+                // Исключение уже передано через future
+            }
+            std::lock_guard<std::mutex> guard(mutex);
+            --pendingAsync;
+            asyncDone.notify_all();
+        });
+        return future;
+    }
+
+    bool contains(const Key& key) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cache.contains(key);
+    }
+
+    // Кладёт значение напрямую, минуя загрузчик
+    void put(const Key& key, const Value& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.access(key, value);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cache.size();
+    }
+
+    // Сколько ключей загружается прямо сейчас
+    size_t loading() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return inFlight.count();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.clear();
+    }
+};
+
+#endif //L3_LOADINGCACHE_H
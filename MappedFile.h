@@ -0,0 +1,129 @@
+#ifndef L3_MAPPEDFILE_H
+#define L3_MAPPEDFILE_H
+
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Как будут читать отображённый файл - подсказка ядру через madvise
+enum class AccessPattern {
+    Normal,
+    Sequential, // Подгружать вперёд и освобождать прочитанное
+    Random // Не читать вперёд
+};
+
+// Файл, целиком отображённый в память только для чтения. Отображение снимается, когда
+// исчезает последний shared_ptr на объект, поэтому его держат и кэш, и выданные FileView
+class MappedFile {
+private:
+    std::string path_;
+    const char* data_;
+    size_t size_;
+
+    MappedFile(std::string path, const char* data, size_t size)
+        : path_(std::move(path)), data_(data), size_(size) {}
+
+public:
+    static std::shared_ptr<MappedFile> open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        const char* data = nullptr;
+        if (size != 0) { // Пустой файл отобразить нельзя
+            void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map file: " + path);
+            }
+            data = static_cast<const char*>(mapping);
+        }
+        ::close(fd); // Отображение остаётся действительным и без дескриптора
+        return std::shared_ptr<MappedFile>(new MappedFile(path, data, size));
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    const std::string& path() const {
+        return path_;
+    }
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    // Подсказка для диапазона [offset, offset + length), границы округляются до страниц
+    void advise(uint64_t offset, size_t length, AccessPattern pattern) const {
+        if (!data_ || pattern == AccessPattern::Normal || length == 0 || offset >= size_) {
+            return;
+        }
+        static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t begin = static_cast<size_t>(offset) / pageSize * pageSize;
+        size_t end = length < size_ - offset ? static_cast<size_t>(offset) + length : size_;
+        void* start = const_cast<char*>(data_) + begin;
+        if (pattern == AccessPattern::Sequential) {
+            ::madvise(start, end - begin, MADV_SEQUENTIAL);
+            ::madvise(start, end - begin, MADV_WILLNEED); // Начинаем подгрузку сразу
+        } else {
+            ::madvise(start, end - begin, MADV_RANDOM);
+        }
+    }
+};
+
+// Участок отображённого файла без копирования. Пока FileView существует, отображение не снимается
+class FileView {
+private:
+    std::shared_ptr<const MappedFile> file;
+    std::string_view bytes;
+
+public:
+    FileView() = default;
+
+    FileView(std::shared_ptr<const MappedFile> file, std::string_view bytes)
+        : file(std::move(file)), bytes(bytes) {}
+
+    const char* data() const {
+        return bytes.data();
+    }
+
+    size_t size() const {
+        return bytes.size();
+    }
+
+    bool empty() const {
+        return bytes.empty();
+    }
+
+    std::string_view view() const {
+        return bytes;
+    }
+
+    operator std::string_view() const {
+        return bytes;
+    }
+};
+
+#endif //L3_MAPPEDFILE_H
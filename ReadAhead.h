@@ -0,0 +1,98 @@
+#ifndef L3_READAHEAD_H
+#define L3_READAHEAD_H
+
+#include "BlockCache.h"
+#include "LRUCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// Упреждающее чтение для BlockCache. Для каждого файла запоминается, где закончилось прошлое чтение:
+// если следующее начинается там же, доступ считается последовательным и окно упреждения
+// (в блоках) удваивается до maxWindow, иначе уменьшается вчетверо. Следующие за прочитанным
+// блоки загружаются в кэш на пуле потоков. Новая порция заказывается, когда впереди читателя
+// осталось меньше половины окна, поэтому при потоковом чтении диск занят непрерывно
+class ReadAhead {
+private:
+    struct Stream {
+        uint64_t nextOffset = 0; // Где закончилось прошлое чтение
+        uint64_t prefetchedUntil = 0; // Блоки до этого номера уже заказаны
+        size_t window = 0; // Окно упреждения в блоках, 0 - выключено
+
+        friend std::ostream& operator<<(std::ostream& out, const Stream& stream) {
+            return out << "next " << stream.nextOffset << ", window " << stream.window;
+        }
+    };
+
+    BlockCache& cache;
+    size_t initialWindow;
+    size_t maxWindow;
+    LRUCache<std::string, Stream> streams; // Состояния недавно читавшихся файлов
+    std::mutex mutex;
+    ThreadPool pool; // Уничтожается первым: задачи обращаются к cache
+
+public:
+    static constexpr size_t maxStreams = 256;
+
+    ReadAhead(BlockCache& cache, size_t threads, size_t maxWindow, size_t initialWindow = 4)
+        : cache(cache), initialWindow(std::max<size_t>(1, std::min(initialWindow, maxWindow))),
+          maxWindow(maxWindow), streams(maxStreams), pool(threads) {
+        if (maxWindow == 0) {
+            throw std::invalid_argument("Read-ahead window must be positive");
+        }
+    }
+
+    // Сообщает о чтении [offset, offset + length) файла path и при необходимости
+    // заказывает загрузку следующих блоков. Сам диск не читает
+    void onRead(const std::string& path, uint64_t offset, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        uint64_t nextBlock = (offset + length - 1) / cache.blockSize() + 1; // Первый блок после прочитанного
+        uint64_t from = 0, until = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Stream* stream = streams.find(path);
+            if (!stream) {
+                streams.access(path, Stream());
+                stream = streams.find(path);
+            }
+            if (offset == stream->nextOffset) { // Продолжение предыдущего чтения (или начало файла)
+                stream->window = stream->window == 0 ? initialWindow
+                                 : stream->window * 2 < maxWindow ? stream->window * 2 : maxWindow;
+            } else {
+                stream->window /= 4;
+                stream->prefetchedUntil = 0;
+            }
+            stream->nextOffset = offset + length;
+            if (stream->window != 0 && stream->prefetchedUntil < nextBlock + stream->window / 2) {
+                from = stream->prefetchedUntil > nextBlock ? stream->prefetchedUntil : nextBlock;
+                until = nextBlock + stream->window;
+                stream->prefetchedUntil = until;
+            }
+        }
+        if (from < until) {
+            pool.submit([this, path, from, until] {
+                cache.prefetch(path, from, static_cast<size_t>(until - from));
+            });
+        }
+    }
+
+    // Текущее окно упреждения файла в блоках (0 - файл не читается последовательно)
+    size_t window(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Stream* stream = streams.find(path);
+        return stream ? stream->window : 0;
+    }
+
+    // Ждёт окончания всех заказанных загрузок
+    void wait() {
+        pool.wait();
+    }
+};
+
+#endif //L3_READAHEAD_H
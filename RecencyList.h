@@ -0,0 +1,178 @@
+#ifndef L3_RECENCYLIST_H
+#define L3_RECENCYLIST_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+// Двусвязный список порядка использования (от самого старого к самому новому).
+// Узлы лежат в едином пуле (slab) и связаны индексами, а не указателями,
+// поэтому рост пула не ломает связи, а все операции выполняются за O(1)
+template <typename Key, typename Value>
+class RecencyList {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1); // "Нет узла"
+
+private:
+    struct Node {
+        Key key;
+        Value value;
+        size_t prev = npos;
+        size_t next = npos;
+    };
+
+    Node* nodes; // Пул узлов
+    size_t capacity_; // Размер пула
+    size_t used; // Сколько узлов пула уже выдавалось хотя бы раз
+    size_t freeHead; // Голова списка освободившихся узлов (связан через next)
+    size_t head; // Самый старый элемент
+    size_t tail; // Самый новый элемент
+    size_t length; // Количество элементов в списке
+
+    void grow(size_t new_capacity) {
+        Node* new_nodes = new Node[new_capacity];
+        for (size_t i = 0; i < used; ++i) {
+            new_nodes[i] = std::move(nodes[i]);
+        }
+        delete[] nodes;
+        nodes = new_nodes;
+        capacity_ = new_capacity;
+    }
+
+    size_t allocate() {
+        if (freeHead != npos) {
+            size_t index = freeHead;
+            freeHead = nodes[index].next;
+            return index;
+        }
+        if (used == capacity_) {
+            grow(capacity_ == 0 ? 16 : capacity_ * 2);
+        }
+        return used++;
+    }
+
+    void unlink(size_t index) {
+        Node& node = nodes[index];
+        if (node.prev != npos) {
+            nodes[node.prev].next = node.next;
+        } else {
+            head = node.next;
+        }
+        if (node.next != npos) {
+            nodes[node.next].prev = node.prev;
+        } else {
+            tail = node.prev;
+        }
+        node.prev = npos;
+        node.next = npos;
+    }
+
+    void linkBack(size_t index) {
+        nodes[index].prev = tail;
+        nodes[index].next = npos;
+        if (tail != npos) {
+            nodes[tail].next = index;
+        } else {
+            head = index;
+        }
+        tail = index;
+    }
+
+public:
+    RecencyList() : nodes(nullptr), capacity_(0), used(0), freeHead(npos), head(npos), tail(npos), length(0) {}
+
+    explicit RecencyList(size_t initial_capacity) : RecencyList() {
+        reserve(initial_capacity);
+    }
+
+    RecencyList(const RecencyList&) = delete;
+    RecencyList& operator=(const RecencyList&) = delete;
+
+    ~RecencyList() {
+        delete[] nodes;
+    }
+
+    // Заранее выделяет пул, чтобы вставки не приводили к перевыделению памяти
+    void reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            grow(new_capacity);
+        }
+    }
+
+    // Добавляет элемент как самый новый и возвращает индекс его узла
+    template <typename K, typename V>
+    size_t pushBack(K&& key, V&& value) {
+        size_t index = allocate();
+        nodes[index].key = std::forward<K>(key);
+        nodes[index].value = std::forward<V>(value);
+        linkBack(index);
+        ++length;
+        return index;
+    }
+
+    // Помечает элемент как самый новый
+    void moveToBack(size_t index) {
+        if (index == tail) {
+            return;
+        }
+        unlink(index);
+        linkBack(index);
+    }
+
+    // Удаляет элемент и возвращает его узел в пул
+    void remove(size_t index) {
+        unlink(index);
+        nodes[index].key = Key{}; // Освобождаем память, которую могли занимать ключ и значение
+        nodes[index].value = Value{};
+        nodes[index].next = freeHead;
+        freeHead = index;
+        --length;
+    }
+
+    size_t front() const { // Индекс самого старого элемента (npos, если список пуст)
+        return head;
+    }
+
+    size_t back() const { // Индекс самого нового элемента
+        return tail;
+    }
+
+    size_t next(size_t index) const { // Следующий (более новый) элемент
+        return nodes[index].next;
+    }
+
+    const Key& key(size_t index) const {
+        return nodes[index].key;
+    }
+
+    Value& value(size_t index) {
+        return nodes[index].value;
+    }
+
+    const Value& value(size_t index) const {
+        return nodes[index].value;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    bool empty() const {
+        return length == 0;
+    }
+
+    // Пул сохраняется, чтобы кэш после очистки снова заполнялся без выделений памяти
+    void clear() {
+        for (size_t i = 0; i < used; ++i) {
+            nodes[i].key = Key{};
+            nodes[i].value = Value{};
+        }
+        used = 0;
+        freeHead = npos;
+        head = npos;
+        tail = npos;
+        length = 0;
+    }
+};
+
+#endif //L3_RECENCYLIST_H
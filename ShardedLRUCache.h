@@ -0,0 +1,250 @@
+#ifndef L3_SHARDEDLRUCACHE_H
+#define L3_SHARDEDLRUCACHE_H
+
+#include "ICache.h"
+#include "Hash.h"
+#include "LRUCache.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Потокобезопасный LRU-кэш: ключи распределяются по независимым шардам,
+// у каждого шарда свой мьютекс и свой порядок использования.
+// Потоки, работающие с разными шардами, не мешают друг другу
+template <typename Key, typename Value, typename Stats = NoStats>
+class ShardedLRUCache : public ICache<Key, Value> {
+public:
+    using ShardCache = LRUCache<Key, Value, DefaultWeigher<Value>, Stats>;
+    using Duration = typename ShardCache::Duration;
+
+private:
+    struct alignas(64) Shard { // Выравнивание, чтобы соседние шарды не делили кэш-линию
+        mutable std::mutex mutex;
+        ShardCache cache;
+
+        explicit Shard(size_t capacity) : cache(capacity) {}
+    };
+
+    Shard** shards;
+    size_t shardCount_;
+    size_t capacity_;
+
+    std::thread reaperThread; // Фоновый сборщик просроченных элементов
+    std::mutex reaperMutex;
+    std::condition_variable reaperWake;
+    bool reaperRunning = false;
+
+    size_t shardIndex(const Key& key) const {
+        // Старшие биты хэша: младшие Dictionary шарда использует для выбора ячейки
+        uint64_t h = static_cast<uint64_t>(DefaultHash<Key>{}(key));
+        return static_cast<size_t>((h >> 32) % shardCount_);
+    }
+
+    Shard& shardFor(const Key& key) const {
+        return *shards[shardIndex(key)];
+    }
+
+public:
+    // Количество шардов по умолчанию - число аппаратных потоков
+    static size_t defaultShardCount() {
+        unsigned threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 16 : threads;
+    }
+
+    // capacity делится между шардами поровну, остаток достаётся первым шардам.
+    // Шардов не больше capacity: шард нулевой ёмкости не смог бы хранить свои ключи
+    explicit ShardedLRUCache(size_t capacity, size_t shardCount = defaultShardCount())
+        : shardCount_(shardCount), capacity_(capacity) {
+        if (shardCount_ == 0) {
+            throw std::invalid_argument("Shard count must be positive");
+        }
+        if (shardCount_ > capacity_) {
+            shardCount_ = capacity_ == 0 ? 1 : capacity_;
+        }
+        shards = new Shard*[shardCount_];
+        for (size_t i = 0; i < shardCount_; ++i) {
+            shards[i] = new Shard(capacity_ / shardCount_ + (i < capacity_ % shardCount_ ? 1 : 0));
+        }
+    }
+
+    ShardedLRUCache(const ShardedLRUCache&) = delete;
+    ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+    ~ShardedLRUCache() override {
+        stopReaper();
+        for (size_t i = 0; i < shardCount_; ++i) {
+            delete shards[i];
+        }
+        delete[] shards;
+    }
+
+    void access(const Key& key, const Value& value) override {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.access(key, value);
+    }
+
+    void access(const Key& key, const Value& value, Duration ttl) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.access(key, value, ttl);
+    }
+
+    void insert(Key&& key, Value&& value) override {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.insert(std::move(key), std::move(value));
+    }
+
+    bool contains(const Key& key) const override {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.contains(key);
+    }
+
+    // Ссылка остаётся корректной, пока другой поток не изменит этот шард.
+    // Для конкурентного доступа используйте try_get или get_copy
+    Value& get(const Key& key) override {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.get(key);
+    }
+
+    const Value& get(const Key& key) const override {
+        const Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return static_cast<const ShardCache&>(shard.cache).get(key);
+    }
+
+    // Указатель действителен, пока другой поток не изменит этот шард
+    Value* find(const Key& key) override {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.find(key);
+    }
+
+    // Копирует значение под блокировкой шарда
+    bool try_get(const Key& key, Value& out) override {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Value* value = shard.cache.find(key);
+        if (!value) {
+            return false;
+        }
+        out = *value;
+        return true;
+    }
+
+    bool concurrent() const override {
+        return true;
+    }
+
+    Value get_copy(const Key& key) {
+        Value value;
+        if (!try_get(key, value)) {
+            throw std::runtime_error("Key not found");
+        }
+        return value;
+    }
+
+    size_t size() const override {
+        size_t total = 0;
+        for (size_t i = 0; i < shardCount_; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            total += shards[i]->cache.size();
+        }
+        return total;
+    }
+
+    void print() const override {
+        for (size_t i = 0; i < shardCount_; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            std::cout << "Shard " << i << ": ";
+            shards[i]->cache.print();
+        }
+    }
+
+    void clear() override {
+        for (size_t i = 0; i < shardCount_; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            shards[i]->cache.clear();
+        }
+    }
+
+    // Суммарная статистика всех шардов
+    CacheStats stats() const {
+        CacheStats total;
+        for (size_t i = 0; i < shardCount_; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            total += shards[i]->cache.stats();
+        }
+        return total;
+    }
+
+    void setDefaultTtl(Duration ttl) {
+        for (size_t i = 0; i < shardCount_; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            shards[i]->cache.setDefaultTtl(ttl);
+        }
+    }
+
+    // Удаляет просроченные элементы во всех шардах (шарды с выключенным сборщиком пропускаются)
+    size_t reapExpired() {
+        size_t removed = 0;
+        for (size_t i = 0; i < shardCount_; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            removed += shards[i]->cache.reapExpired();
+        }
+        return removed;
+    }
+
+    // Запускает фоновый поток, который раз в interval удаляет просроченные элементы,
+    // так что память освобождается и для ключей, к которым больше никто не обращается
+    void startReaper(std::chrono::milliseconds interval = std::chrono::milliseconds(100)) {
+        stopReaper();
+        for (size_t i = 0; i < shardCount_; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            shards[i]->cache.enableReaper(interval);
+        }
+        reaperRunning = true;
+        reaperThread = std::thread([this, interval]() {
+            std::unique_lock<std::mutex> lock(reaperMutex);
+            while (reaperRunning) {
+                reaperWake.wait_for(lock, interval);
+                if (!reaperRunning) {
+                    break;
+                }
+                lock.unlock();
+                reapExpired();
+                lock.lock();
+            }
+        });
+    }
+
+    void stopReaper() {
+        {
+            std::lock_guard<std::mutex> lock(reaperMutex);
+            reaperRunning = false;
+        }
+        reaperWake.notify_all();
+        if (reaperThread.joinable()) {
+            reaperThread.join();
+        }
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t shardCount() const {
+        return shardCount_;
+    }
+};
+
+#endif //L3_SHARDEDLRUCACHE_H
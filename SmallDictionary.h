@@ -0,0 +1,259 @@
+#ifndef L3_SMALLDICTIONARY_H
+#define L3_SMALLDICTIONARY_H
+
+#include "IDictionary.h"
+#include "Dictionary.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+// Словарь для множества маленьких наборов (например, дочерних узлов VFS). Пустой словарь
+// не выделяет памяти вовсе, до Threshold элементов хранит их в отсортированном массиве
+// (поиск двоичный, одно выделение памяти на весь набор), а при превышении порога переходит
+// на Dictionary. Если после удалений элементов становится меньше Threshold / 2, словарь
+// возвращается к массиву. Сам объект занимает несколько указателей, а не целую хэш-таблицу
+template <typename Key, typename Value, typename Hash = DefaultHash<Key>, size_t Threshold = 8>
+class SmallDictionary : public IDictionary<Key, Value> {
+private:
+    using Large = Dictionary<Key, Value, Hash>;
+
+    struct KeyValue {
+        Key key;
+        Value value;
+    };
+
+    Hash hasher; // Нужен только для перехода на Dictionary
+    KeyValue* small = nullptr; // Отсортирован по ключу
+    Large* large = nullptr;
+    uint32_t smallSize = 0;
+    uint32_t smallCapacity = 0;
+
+    // Первая позиция, где ключ не меньше key
+    template <typename K>
+    size_t lowerBound(const K& key) const {
+        size_t left = 0, right = smallSize;
+        while (left < right) {
+            size_t middle = (left + right) / 2;
+            if (small[middle].key < key) {
+                left = middle + 1;
+            } else {
+                right = middle;
+            }
+        }
+        return left;
+    }
+
+    template <typename K>
+    KeyValue* findSmall(const K& key) const {
+        size_t position = lowerBound(key);
+        return position < smallSize && small[position].key == key ? &small[position] : nullptr;
+    }
+
+    void growSmall() {
+        uint32_t capacity = smallCapacity == 0 ? 1 : smallCapacity * 2; // Под фактическое число детей
+        KeyValue* grown = new KeyValue[capacity];
+        std::move(small, small + smallSize, grown);
+        delete[] small;
+        small = grown;
+        smallCapacity = capacity;
+    }
+
+    void promote() {
+        large = new Large(Threshold * 2, hasher);
+        for (uint32_t i = 0; i < smallSize; ++i) {
+            large->add(std::move(small[i].key), std::move(small[i].value));
+        }
+        delete[] small;
+        small = nullptr;
+        smallSize = smallCapacity = 0;
+    }
+
+    void demote() {
+        smallCapacity = static_cast<uint32_t>(Threshold);
+        small = new KeyValue[smallCapacity];
+        large->for_each([this](const Key& key, Value& value) {
+            small[smallSize++] = KeyValue{key, std::move(value)};
+        });
+        std::sort(small, small + smallSize, [](const KeyValue& a, const KeyValue& b) { return a.key < b.key; });
+        delete large;
+        large = nullptr;
+    }
+
+    template <typename K, typename V>
+    void insert(K&& key, V&& value) {
+        if (large) {
+            large->add(Key(std::forward<K>(key)), Value(std::forward<V>(value)));
+            return;
+        }
+        size_t position = lowerBound(key);
+        if (position < smallSize && small[position].key == key) {
+            small[position].value = std::forward<V>(value);
+            return;
+        }
+        if (smallSize == Threshold) {
+            promote();
+            insert(std::forward<K>(key), std::forward<V>(value));
+            return;
+        }
+        if (smallSize == smallCapacity) {
+            growSmall();
+        }
+        std::move_backward(small + position, small + smallSize, small + smallSize + 1);
+        small[position] = KeyValue{Key(std::forward<K>(key)), Value(std::forward<V>(value))};
+        ++smallSize;
+    }
+
+    template <typename K>
+    void erase(const K& key) {
+        if (large) {
+            large->remove(key);
+            if (large->count() < Threshold / 2) {
+                demote();
+            }
+            return;
+        }
+        size_t position = lowerBound(key);
+        if (position >= smallSize || !(small[position].key == key)) {
+            throw std::runtime_error("Key not found");
+        }
+        std::move(small + position + 1, small + smallSize, small + position);
+        small[--smallSize] = KeyValue(); // Сразу освобождаем память ключа и значения
+        if (smallSize == 0) {
+            delete[] small;
+            small = nullptr;
+            smallCapacity = 0;
+        }
+    }
+
+public:
+    SmallDictionary() = default;
+
+    explicit SmallDictionary(Hash hasher) : hasher(std::move(hasher)) {}
+
+    SmallDictionary(const SmallDictionary&) = delete;
+    SmallDictionary& operator=(const SmallDictionary&) = delete;
+
+    ~SmallDictionary() override {
+        delete[] small;
+        delete large;
+    }
+
+    size_t count() const override {
+        return large ? large->count() : smallSize;
+    }
+
+    size_t capacity() const override {
+        return large ? large->capacity() : smallCapacity;
+    }
+
+    // Перешёл ли словарь на хэш-таблицу
+    bool isLarge() const {
+        return large != nullptr;
+    }
+
+    bool contains_key(const Key& key) const override {
+        return find(key) != nullptr;
+    }
+
+    void add(const Key& key, const Value& value) override {
+        insert(key, value);
+    }
+
+    void add(Key&& key, Value&& value) {
+        insert(std::move(key), std::move(value));
+    }
+
+    void remove(const Key& key) override {
+        erase(key);
+    }
+
+    Value& get(const Key& key) override {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    const Value& get(const Key& key) const override {
+        const Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    Value* find(const Key& key) override {
+        if (large) {
+            return large->find(key);
+        }
+        KeyValue* entry = findSmall(key);
+        return entry ? &entry->value : nullptr;
+    }
+
+    const Value* find(const Key& key) const override {
+        if (large) {
+            return static_cast<const Large*>(large)->find(key);
+        }
+        const KeyValue* entry = findSmall(key);
+        return entry ? &entry->value : nullptr;
+    }
+
+    // Поиск без создания ключа (для строковых ключей - по string_view)
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    Value* find(const K& key) {
+        if (large) {
+            return large->find(key);
+        }
+        KeyValue* entry = findSmall(std::string_view(key));
+        return entry ? &entry->value : nullptr;
+    }
+
+    template <typename K, EnableTransparent<Key, Hash, K> = 0>
+    void remove(const K& key) {
+        erase(std::string_view(key));
+    }
+
+    Value& operator[](const Key& key) override {
+        if (Value* value = find(key)) {
+            return *value;
+        }
+        insert(key, Value{});
+        return *find(key);
+    }
+
+    // Вызывает visitor(key, value) для каждого элемента; в режиме массива - по возрастанию ключей
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) {
+        if (large) {
+            large->for_each(visitor);
+            return;
+        }
+        for (uint32_t i = 0; i < smallSize; ++i) {
+            visitor(static_cast<const Key&>(small[i].key), small[i].value);
+        }
+    }
+
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const {
+        if (large) {
+            static_cast<const Large*>(large)->for_each(visitor);
+            return;
+        }
+        for (uint32_t i = 0; i < smallSize; ++i) {
+            visitor(static_cast<const Key&>(small[i].key), static_cast<const Value&>(small[i].value));
+        }
+    }
+
+    void clear() override {
+        delete[] small;
+        delete large;
+        small = nullptr;
+        large = nullptr;
+        smallSize = smallCapacity = 0;
+    }
+};
+
+#endif //L3_SMALLDICTIONARY_H
@@ -0,0 +1,114 @@
+#ifndef L3_THREADPOOL_H
+#define L3_THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Пул потоков с общей очередью задач (FIFO). Исключения задач перехватываются и отбрасываются:
+// пул предназначен для фоновой работы, результат которой не обязателен (например, упреждающего чтения).
+// При уничтожении пул дожидается выполняемых задач, а ещё не начатые отбрасывает
+class ThreadPool {
+private:
+    struct Task {
+        std::function<void()> job;
+        Task* next;
+    };
+
+    std::thread* workers;
+    size_t workerCount;
+    Task* head; // Очередь задач - односвязный список
+    Task* tail;
+    size_t active; // Сколько задач выполняется прямо сейчас
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable wake; // Появилась задача или пул останавливается
+    std::condition_variable idle; // Очередь опустела и все задачи выполнены
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || head; });
+            if (stopping) {
+                return;
+            }
+            Task* task = head;
+            head = task->next;
+            if (!head) {
+                tail = nullptr;
+            }
+            ++active;
+            lock.unlock();
+            try {
+                task->job();
+            } catch (...) {
+            }
+            delete task;
+            lock.lock();
+            --active;
+            if (!head && active == 0) {
+                idle.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads) : workerCount(threads), head(nullptr), tail(nullptr), active(0), stopping(false) {
+        if (threads == 0) {
+            throw std::invalid_argument("Thread count must be positive");
+        }
+        workers = new std::thread[threads];
+        for (size_t i = 0; i < threads; ++i) {
+            workers[i] = std::thread([this] { run(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers[i].join();
+        }
+        delete[] workers;
+        while (head) {
+            Task* next = head->next;
+            delete head;
+            head = next;
+        }
+    }
+
+    void submit(std::function<void()> job) {
+        Task* task = new Task{std::move(job), nullptr};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tail) {
+                tail->next = task;
+            } else {
+                head = task;
+            }
+            tail = task;
+        }
+        wake.notify_one();
+    }
+
+    // Ждёт, пока все поставленные задачи не будут выполнены
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return !head && active == 0; });
+    }
+
+    size_t threadCount() const {
+        return workerCount;
+    }
+};
+
+#endif //L3_THREADPOOL_H
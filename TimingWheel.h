@@ -0,0 +1,116 @@
+#ifndef L3_TIMINGWHEEL_H
+#define L3_TIMINGWHEEL_H
+
+#include "ArraySequence.h"
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+// Хэшированное колесо таймеров. Время делится на тики длиной tick, таймер кладётся в ячейку
+// (номер тика дедлайна) % wheelSize. При продвижении колеса просматриваются только ячейки
+// прошедших тиков, поэтому каждый таймер проверяется O(1) раз за оборот, без обхода всех записей
+template <typename Id>
+class TimingWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = Clock::duration;
+
+private:
+    struct Timer {
+        Id id{};
+        TimePoint deadline{};
+    };
+
+    ArraySequence<Timer>* buckets;
+    size_t wheelSize;
+    Duration tick;
+    TimePoint start; // Момент, от которого отсчитываются тики
+    int64_t currentTick; // Все ячейки до этого тика уже обработаны
+    size_t pending; // Сколько таймеров лежит в колесе
+
+    int64_t tickOf(TimePoint time) const {
+        return static_cast<int64_t>((time - start) / tick);
+    }
+
+    template <typename OnExpired>
+    void processBucket(size_t bucket, TimePoint now, OnExpired& onExpired) {
+        ArraySequence<Timer>& timers = buckets[bucket];
+        if (timers.getLength() == 0) {
+            return;
+        }
+        ArraySequence<Timer> later; // Таймеры следующих оборотов колеса
+        for (int i = 0; i < timers.getLength(); ++i) {
+            Timer timer = timers[i]; // Копия: onExpired может добавить таймер в эту же ячейку
+            if (timer.deadline <= now) {
+                --pending;
+                onExpired(timer.id, timer.deadline);
+            } else {
+                later.append(timer);
+            }
+        }
+        timers.clear();
+        for (int i = 0; i < later.getLength(); ++i) {
+            timers.append(later[i]);
+        }
+    }
+
+public:
+    explicit TimingWheel(Duration tick = std::chrono::milliseconds(100), size_t wheelSize = 512,
+                         TimePoint start = Clock::now())
+        : wheelSize(wheelSize), tick(tick), start(start), currentTick(0), pending(0) {
+        if (wheelSize == 0 || tick <= Duration::zero()) {
+            throw std::invalid_argument("Timing wheel needs a positive tick and size");
+        }
+        buckets = new ArraySequence<Timer>[wheelSize];
+    }
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    ~TimingWheel() {
+        delete[] buckets;
+    }
+
+    void schedule(const Id& id, TimePoint deadline) {
+        int64_t due = tickOf(deadline);
+        if (due < currentTick) {
+            due = currentTick; // Уже просроченный таймер сработает при ближайшем продвижении
+        }
+        buckets[static_cast<size_t>(due) % wheelSize].append({id, deadline});
+        ++pending;
+    }
+
+    // Вызывает onExpired(id, deadline) для всех таймеров с дедлайном не позже now.
+    // Из onExpired можно планировать новые таймеры
+    template <typename OnExpired>
+    void advance(TimePoint now, OnExpired onExpired) {
+        int64_t target = tickOf(now);
+        if (target < currentTick || pending == 0) {
+            currentTick = target > currentTick ? target : currentTick;
+            return;
+        }
+        // Больше одного оборота за раз не нужно: каждую ячейку достаточно просмотреть один раз
+        int64_t steps = target - currentTick + 1;
+        if (steps > static_cast<int64_t>(wheelSize)) {
+            steps = static_cast<int64_t>(wheelSize);
+        }
+        for (int64_t i = 0; i < steps; ++i) {
+            processBucket(static_cast<size_t>(target - i) % wheelSize, now, onExpired);
+        }
+        currentTick = target;
+    }
+
+    size_t size() const {
+        return pending;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < wheelSize; ++i) {
+            buckets[i].clear();
+        }
+        pending = 0;
+    }
+};
+
+#endif //L3_TIMINGWHEEL_H
@@ -0,0 +1,155 @@
+#ifndef L3_TWOQUEUECACHE_H
+#define L3_TWOQUEUECACHE_H
+
+#include "ICache.h"
+#include "Dictionary.h"
+#include "RecencyList.h"
+#include <iostream>
+#include <stdexcept>
+
+// Кэш 2Q (Johnson, Shasha). Новые элементы попадают в FIFO-очередь A1in, вытесненные из неё
+// ключи запоминаются в "призрачной" очереди A1out (без значений). В основную LRU-очередь Am
+// попадают только ключи, к которым обратились повторно, пока они были в A1out.
+// Поэтому однократный проход по большому числу ключей вытесняет только A1in, а не горячие данные
+template <typename Key, typename Value>
+class TwoQueueCache : public ICache<Key, Value> {
+private:
+    enum Queue : unsigned char { In, Out, Main };
+
+    struct Location {
+        Queue queue = In;
+        size_t index = 0;
+    };
+
+    using List = RecencyList<Key, Value>;
+
+    size_t capacity_;
+    size_t inCapacity; // Размер A1in (четверть кэша)
+    size_t outCapacity; // Размер A1out (половина кэша, хранятся только ключи)
+    List in; // A1in - FIFO недавно добавленных
+    List out; // A1out - FIFO ключей, вытесненных из A1in
+    List main; // Am - LRU горячих элементов
+    Dictionary<Key, Location> locations; // Где сейчас находится ключ
+
+    List& listOf(Queue queue) {
+        return queue == In ? in : (queue == Out ? out : main);
+    }
+
+    void forgetOldestGhost() {
+        size_t oldest = out.front();
+        locations.remove(out.key(oldest));
+        out.remove(oldest);
+    }
+
+    // Освобождает место под новый элемент
+    void reclaim() {
+        if (in.size() + main.size() < capacity_) {
+            return;
+        }
+        if (in.size() > inCapacity || main.empty()) {
+            size_t oldest = in.front();
+            Key key = in.key(oldest);
+            in.remove(oldest);
+            if (out.size() >= outCapacity) {
+                forgetOldestGhost();
+            }
+            locations[key] = {Out, out.pushBack(key, Value{})};
+        } else {
+            size_t oldest = main.front();
+            locations.remove(main.key(oldest));
+            main.remove(oldest);
+        }
+    }
+
+public:
+    explicit TwoQueueCache(size_t capacity)
+        : capacity_(capacity),
+          inCapacity(capacity / 4 == 0 ? 1 : capacity / 4),
+          outCapacity(capacity / 2 == 0 ? 1 : capacity / 2) {}
+
+    void access(const Key& key, const Value& value) override {
+        if (Location* found = locations.find(key)) {
+            Location location = *found;
+            if (location.queue == Main) {
+                main.value(location.index) = value;
+                main.moveToBack(location.index);
+                return;
+            }
+            if (location.queue == In) {
+                in.value(location.index) = value; // A1in - FIFO, порядок не меняем
+                return;
+            }
+            // Повторное обращение к недавно вытесненному ключу - переносим его в Am
+            out.remove(location.index);
+            locations.remove(key);
+            reclaim();
+            locations.add(key, {Main, main.pushBack(key, value)});
+            return;
+        }
+        if (capacity_ == 0) {
+            return;
+        }
+        reclaim();
+        locations.add(key, {In, in.pushBack(key, value)});
+    }
+
+    bool contains(const Key& key) const override {
+        const Location* location = locations.find(key);
+        return location && location->queue != Out;
+    }
+
+    Value& get(const Key& key) override {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    const Value& get(const Key& key) const override {
+        const Location* location = locations.find(key);
+        if (!location || location->queue == Out) {
+            throw std::runtime_error("Key not found");
+        }
+        return location->queue == Main ? main.value(location->index) : in.value(location->index);
+    }
+
+    Value* find(const Key& key) override {
+        Location* location = locations.find(key);
+        if (!location || location->queue == Out) {
+            return nullptr;
+        }
+        if (location->queue == Main) {
+            main.moveToBack(location->index);
+        }
+        return &listOf(location->queue).value(location->index);
+    }
+
+    size_t size() const override {
+        return in.size() + main.size();
+    }
+
+    void print() const override {
+        std::cout << "Cache contents (A1in):\n";
+        for (size_t i = in.front(); i != List::npos; i = in.next(i)) {
+            std::cout << "Key: " << in.key(i) << ", Value: " << in.value(i) << "\n";
+        }
+        std::cout << "Cache contents (Am):\n";
+        for (size_t i = main.front(); i != List::npos; i = main.next(i)) {
+            std::cout << "Key: " << main.key(i) << ", Value: " << main.value(i) << "\n";
+        }
+    }
+
+    void clear() override {
+        in.clear();
+        out.clear();
+        main.clear();
+        locations.clear();
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+};
+
+#endif //L3_TWOQUEUECACHE_H
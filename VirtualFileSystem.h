@@ -2,11 +2,16 @@
 #define L3_VIRTUALFILESYSTEM_H
 
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include "ArraySequence.h"
-#include "Set.h"  // Подключаем контейнер Set
-#include "Dictionary.h"  // Подключаем хэш-таблицу Dictionary
+#include "SmallDictionary.h"  // Подключаем словарь для небольших наборов
+#include "BlockCache.h"  // Кэш содержимого файлов
+#include "MappedFile.h"  // Чтение больших файлов без копирования
+#include "ReadAhead.h"  // Упреждающее чтение
+#include "AsyncReader.h"  // Пакетное асинхронное чтение
 
 class VirtualFileSystem {
 private:
@@ -14,58 +19,109 @@ private:
         std::string name;
         std::string realPath;
         bool isDirectory;
-        Dictionary<std::string, Node*> children;  // Используем Dictionary для хранения дочерних узлов
+        // У большинства узлов детей нет или мало: память выделяется только под реальных детей,
+        // в хэш-таблицу словарь переходит, когда их становится больше нескольких
+        SmallDictionary<std::string, Node*> children;
 
+        // Имена файлов приходят извне, поэтому хэш со случайным seed: подобрать имена,
+        // которые выстроятся в одну длинную цепочку, нельзя
         Node(const std::string& name, bool isDirectory, const std::string& realPath = "")
-            : name(name), realPath(realPath), isDirectory(isDirectory) {}
+            : name(name), realPath(realPath), isDirectory(isDirectory),
+              children(DefaultHash<std::string>::seeded()) {}
 
         ~Node() {
-            auto keys = children.keys();  // Получаем все ключи из Dictionary
-            for (size_t i = 0; i < keys.getLength(); ++i) {
-                delete children.get(keys.get(i));  // Удаляем дочерние узлы по ключу
-            }
+            children.for_each([](const std::string&, Node* child) {
+                delete child;  // Удаляем дочерние узлы
+            });
         }
 
     };
 
     Node* root;
-    Set<std::string> uniquePaths;  // Контейнер для хранения уникальных виртуальных путей
+    LRUCache<std::string, Node*> dentries;  // Нормализованный полный путь -> узел (nullptr - пути нет)
+    std::mutex dentriesMutex;  // Попадание в кэш путей тоже меняет его (порядок LRU)
+    BlockCache blockCache;  // Блоки реальных файлов, общие для всех виртуальных путей
+    LRUCache<std::string, std::shared_ptr<const MappedFile>> mappings;  // Реальный путь -> отображение
+    std::mutex mappingsMutex;
+    ReadAhead* readAhead = nullptr;  // nullptr - упреждающее чтение выключено
+    IAsyncReader* asyncReader = nullptr;  // Создаётся при первой пакетной загрузке
+    std::mutex asyncMutex;  // IAsyncReader рассчитан на один поток - пакетные загрузки идут по очереди
+
+    // Нормализованный путь начинается с "/" и не содержит пустых компонентов: "/a/b", но не "/a//b/"
+    static bool isNormalized(std::string_view path) {
+        if (path.empty() || path[0] != '/') {
+            return false;
+        }
+        if (path.size() == 1) {
+            return true;
+        }
+        return path.back() != '/' && path.find("//") == std::string_view::npos;
+    }
 
-    Node* findNode(const std::string& path) {
-        if (path == "/") {
-            return root;
+    static std::string normalize(std::string_view path) {
+        std::string result;
+        result.reserve(path.size() + 1);
+        while (!path.empty()) {
+            size_t end = path.find('/');
+            std::string_view part = path.substr(0, end);
+            path = end == std::string_view::npos ? std::string_view() : path.substr(end + 1);
+            if (!part.empty()) {
+                result += '/';
+                result += part;
+            }
         }
+        return result.empty() ? "/" : result;
+    }
 
-        ArraySequence<std::string> parts = splitPath(path);
-        Node* current = root;
+    // Поиск через кэш путей: повторное разрешение пути любой глубины - одна проба хэш-таблицы.
+    // Отсутствующие пути тоже кэшируются. Можно вызывать из нескольких потоков,
+    // пока дерево не меняется (добавление и удаление узлов по-прежнему однопоточные)
+    Node* findNode(const std::string& path) {
+        if (isNormalized(path)) {  // Обычный случай - без создания строк
+            return lookup(path);
+        }
+        return lookup(normalize(path));
+    }
 
-        for (int i = 0; i < parts.getLength(); ++i) {
-            const std::string& part = parts[i];
-            if (!current->children.contains_key(part)) {
-                return nullptr;  // Узел не найден
-            }
-            current = current->children.get(part);
+    Node* lookup(const std::string& path) {
+        std::lock_guard<std::mutex> lock(dentriesMutex);
+        if (Node** cached = dentries.find(path)) {
+            return *cached;
         }
+        Node* node = walk(path);
+        dentries.access(path, node);
+        return node;
+    }
 
-        return current;
+    // Сбрасывает запись кэша путей для узла, который появился или исчез. Остальные записи
+    // остаются верными: удалять можно только файлы и пустые директории
+    void invalidate(const std::string& virtualPath, const std::string& name) {
+        std::string path = normalize(virtualPath + "/" + name);
+        std::lock_guard<std::mutex> lock(dentriesMutex);
+        dentries.remove(path);
     }
 
-    ArraySequence<std::string> splitPath(const std::string& path) {
-        ArraySequence<std::string> parts;
-        size_t start = 0, end = 0;
+    Node* walk(std::string_view path) {
+        // Идём по компонентам пути как по string_view: строки не создаются, каждое имя
+        // хэшируется один раз
+        std::string_view rest(path);
+        Node* current = root;
 
-        while ((end = path.find('/', start)) != std::string::npos) {
-            if (end != start) {
-                parts.append(path.substr(start, end - start));
+        while (!rest.empty()) {
+            size_t end = rest.find('/');
+            std::string_view part = rest.substr(0, end);
+            rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+            if (part.empty()) {
+                continue;
             }
-            start = end + 1;
-        }
-
-        if (start < path.size()) {
-            parts.append(path.substr(start));
+            Node** child = current->children.find(part);
+            if (!child) {
+                return nullptr;  // Узел не найден
+            }
+            current = *child;
         }
 
-        return parts;
+        return current;
     }
 
     void printTree(Node* node, const std::string& prefix, bool isLast) {
@@ -78,54 +134,114 @@ private:
         }
         std::cout << std::endl;
 
-        auto keys = node->children.keys();  // Получаем ключи из Dictionary
-        for (size_t i = 0; i < keys.getLength(); ++i) {
-            bool lastChild = (i == keys.getLength() - 1);
-            printTree(node->children.get(keys.get(i)), prefix + (isLast ? "    " : "│   "), lastChild);
-        }
+        printChildren(node, prefix + (isLast ? "    " : "│   "));
+    }
+
+    void printChildren(Node* node, const std::string& prefix) {
+        size_t remaining = node->children.count();
+        node->children.for_each([&](const std::string&, Node* child) {
+            printTree(child, prefix, --remaining == 0);
+        });
     }
 
 
 public:
-    VirtualFileSystem() {
+    static constexpr size_t pathCacheSize = 4096;  // Сколько путей помнит кэш путей
+
+    // cacheBytes - сколько байт содержимого файлов держать в памяти
+    // maxMappings - сколько отображённых файлов держать открытыми
+    explicit VirtualFileSystem(size_t cacheBytes = BlockCache::defaultMaxBytes,
+                               size_t blockSize = BlockCache::defaultBlockSize,
+                               size_t maxMappings = 64)
+        : dentries(pathCacheSize), blockCache(cacheBytes, blockSize), mappings(maxMappings) {
         root = new Node("/", true);
-        uniquePaths.insert("/");  // Корневой путь
     }
 
     ~VirtualFileSystem() {
         //delete root;
+        delete readAhead;
+        delete asyncReader;
     }
 
-    void addFile(const std::string& virtualPath, const std::string& realPath, const std::string& fileName) {
-        std::string fullPath = virtualPath + "/" + fileName;
-        if (uniquePaths.contains(fullPath)) {
-            throw std::runtime_error("Path already exists: " + fullPath);
+    // Включает упреждающее чтение для readFile: при последовательном чтении файла следующие блоки
+    // загружаются в кэш заранее на threads фоновых потоках, окно растёт до maxWindowBytes
+    void enableReadAhead(size_t threads = 2, size_t maxWindowBytes = 4 * 1024 * 1024) {
+        delete readAhead;
+        size_t maxWindow = maxWindowBytes / blockCache.blockSize();
+        readAhead = new ReadAhead(blockCache, threads, maxWindow == 0 ? 1 : maxWindow);
+    }
+
+    // Загружает в кэш первые bytesPerFile байт каждого из файлов virtualPaths одной пачкой запросов
+    // (io_uring, а без него - пул потоков), после чего readFile этих участков не обращается к диску.
+    // Возвращает количество прочитанных с диска блоков. Если реальный файл не открывается,
+    // остальные всё равно загружаются, а затем выбрасывается исключение
+    size_t preload(const ArraySequence<std::string>& virtualPaths, size_t bytesPerFile = BlockCache::defaultBlockSize) {
+        size_t blockSize = blockCache.blockSize();
+        size_t blocksPerFile = (bytesPerFile + blockSize - 1) / blockSize;
+        size_t count = static_cast<size_t>(virtualPaths.getLength()) * blocksPerFile;
+        BlockKey* keys = new BlockKey[count];
+        try {
+            for (int i = 0; i < virtualPaths.getLength(); ++i) {
+                Node* file = findNode(virtualPaths.get(i));
+                if (!file || file->isDirectory) {
+                    throw std::runtime_error("File not found: " + virtualPaths.get(i));
+                }
+                for (size_t block = 0; block < blocksPerFile; ++block) {
+                    keys[i * blocksPerFile + block] = BlockKey{file->realPath, block};
+                }
+            }
+        } catch (...) {
+            delete[] keys;
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        if (!asyncReader) {
+            asyncReader = makeAsyncReader();
+        }
+        size_t fetched;
+        try {
+            fetched = blockCache.fetch(*asyncReader, keys, count);
+        } catch (...) {
+            delete[] keys;
+            throw;
         }
+        delete[] keys;
+        return fetched;
+    }
 
+    // Ждёт, пока упреждающее чтение загрузит всё заказанное
+    void waitForReadAhead() {
+        if (readAhead) {
+            readAhead->wait();
+        }
+    }
+
+    void addFile(const std::string& virtualPath, const std::string& realPath, const std::string& fileName) {
         Node* parent = findNode(virtualPath);
         if (!parent || !parent->isDirectory) {
             throw std::runtime_error("Invalid path: " + virtualPath);
         }
+        if (parent->children.find(fileName)) {
+            throw std::runtime_error("Path already exists: " + virtualPath + "/" + fileName);
+        }
 
         Node* fileNode = new Node(fileName, false, realPath);
         parent->children.add(fileName, fileNode);
-        uniquePaths.insert(fullPath);
+        invalidate(virtualPath, fileName);  // Путь мог быть закэширован как отсутствующий
     }
 
     void addDirectory(const std::string& virtualPath, const std::string& dirName) {
-        std::string fullPath = virtualPath + "/" + dirName;
-        if (uniquePaths.contains(fullPath)) {
-            throw std::runtime_error("Path already exists: " + fullPath);
-        }
-
         Node* parent = findNode(virtualPath);
         if (!parent || !parent->isDirectory) {
             throw std::runtime_error("Invalid path: " + virtualPath);
         }
+        if (parent->children.find(dirName)) {
+            throw std::runtime_error("Path already exists: " + virtualPath + "/" + dirName);
+        }
 
         Node* dirNode = new Node(dirName, true);
         parent->children.add(dirName, dirNode);
-        uniquePaths.insert(fullPath);
+        invalidate(virtualPath, dirName);  // Путь мог быть закэширован как отсутствующий
     }
 
     void removeFile(const std::string& virtualPath, const std::string& fileName) {
@@ -134,13 +250,14 @@ public:
             throw std::runtime_error("Invalid path: " + virtualPath);
         }
 
-        if (!parent->children.contains_key(fileName) || parent->children.get(fileName)->isDirectory) {
+        Node** file = parent->children.find(fileName);
+        if (!file || (*file)->isDirectory) {
             throw std::runtime_error("File not found: " + fileName);
         }
 
-        delete parent->children.get(fileName);
+        delete *file;
         parent->children.remove(fileName);
-        uniquePaths.remove(virtualPath + "/" + fileName);
+        invalidate(virtualPath, fileName);
     }
 
     void removeDirectory(const std::string& virtualPath, const std::string& dirName) {
@@ -149,17 +266,60 @@ public:
             throw std::runtime_error("Invalid path: " + virtualPath);
         }
 
-        if (!parent->children.contains_key(dirName) || !parent->children.get(dirName)->isDirectory) {
+        Node** dir = parent->children.find(dirName);
+        if (!dir || !(*dir)->isDirectory) {
             throw std::runtime_error("Directory not found: " + dirName);
         }
 
-        if (parent->children.get(dirName)->children.count() != 0) {
+        if ((*dir)->children.count() != 0) {
             throw std::runtime_error("Directory is not empty: " + dirName);
         }
 
-        delete parent->children.get(dirName);
+        delete *dir;
         parent->children.remove(dirName);
-        uniquePaths.remove(virtualPath + "/" + dirName);
+        invalidate(virtualPath, dirName);
+    }
+
+    // Читает до length байт файла virtualPath начиная с offset. Данные берутся из кэша блоков,
+    // с диска читаются только недостающие блоки
+    std::string readFile(const std::string& virtualPath, uint64_t offset, size_t length) {
+        Node* file = findNode(virtualPath);
+        if (!file || file->isDirectory) {
+            throw std::runtime_error("File not found: " + virtualPath);
+        }
+        if (readAhead) {
+            readAhead->onRead(file->realPath, offset, length); // Следующие блоки грузятся, пока читаем эти
+        }
+        return blockCache.read(file->realPath, offset, length);
+    }
+
+    // То же без копирования: участок отображённого в память файла. Для больших файлов,
+    // которые не стоит дублировать в кэше блоков. Отображение живёт, пока жив FileView,
+    // даже если кэш отображений его уже вытеснил
+    FileView readView(const std::string& virtualPath, uint64_t offset, size_t length,
+                      AccessPattern pattern = AccessPattern::Sequential) {
+        Node* file = findNode(virtualPath);
+        if (!file || file->isDirectory) {
+            throw std::runtime_error("File not found: " + virtualPath);
+        }
+        std::shared_ptr<const MappedFile> mapped;
+        {
+            std::lock_guard<std::mutex> lock(mappingsMutex);
+            mapped = mappings.get_or_load(file->realPath, [&] {
+                return std::shared_ptr<const MappedFile>(MappedFile::open(file->realPath));
+            });
+        }
+        if (offset >= mapped->size()) {
+            return FileView(mapped, std::string_view());
+        }
+        size_t available = static_cast<size_t>(mapped->size() - offset);
+        size_t count = length < available ? length : available;
+        mapped->advise(offset, count, pattern);
+        return FileView(mapped, std::string_view(mapped->data() + offset, count));
+    }
+
+    const BlockCache& cache() const {
+        return blockCache;
     }
 
     void printStructure() {
@@ -169,11 +329,7 @@ public:
         }
         std::cout << root->name << std::endl;
 
-        auto keys = root->children.keys();  // Получаем ключи из корневого Dictionary
-        for (size_t i = 0; i < keys.getLength(); ++i) {
-            bool lastChild = (i == keys.getLength() - 1);
-            printTree(root->children.get(keys.get(i)), "", lastChild);
-        }
+        printChildren(root, "");
     }
 
 };
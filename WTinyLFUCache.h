@@ -0,0 +1,188 @@
+#ifndef L3_WTINYLFUCACHE_H
+#define L3_WTINYLFUCACHE_H
+
+#include "ICache.h"
+#include "Dictionary.h"
+#include "RecencyList.h"
+#include "CountMinSketch.h"
+#include <iostream>
+#include <stdexcept>
+
+// Кэш W-TinyLFU (Einziger, Friedman, Manes).
+// Новые элементы попадают в маленькое LRU-окно (1% ёмкости). Вытесненный из окна кандидат
+// допускается в основную часть, только если по оценке count-min sketch к нему обращались чаще,
+// чем к элементу, который пришлось бы ради него вытеснить. Основная часть - сегментированный LRU:
+// испытательный сегмент (probation) и защищённый (protected, 80% основной части).
+// Ключи однократного прохода имеют частоту 1 и не проходят фильтр допуска
+template <typename Key, typename Value>
+class WTinyLFUCache : public ICache<Key, Value> {
+private:
+    enum Segment : unsigned char { Window, Probation, Protected };
+
+    struct Location {
+        Segment segment = Window;
+        size_t index = 0;
+    };
+
+    using List = RecencyList<Key, Value>;
+
+    size_t capacity_;
+    size_t windowCapacity;
+    size_t mainCapacity;
+    size_t protectedCapacity;
+    List window;
+    List probation;
+    List protectedList;
+    Dictionary<Key, Location> locations;
+    CountMinSketch<Key> sketch; // Частоты обращений, в том числе к уже вытесненным ключам
+
+    List& listOf(Segment segment) {
+        return segment == Window ? window : (segment == Probation ? probation : protectedList);
+    }
+
+    void evictFrom(List& list) {
+        size_t oldest = list.front();
+        locations.remove(list.key(oldest));
+        list.remove(oldest);
+    }
+
+    // Переносит самый старый элемент списка from в конец списка to
+    void transfer(List& from, List& to, Segment segment) {
+        size_t oldest = from.front();
+        Key key = from.key(oldest);
+        Value value = std::move(from.value(oldest));
+        from.remove(oldest);
+        locations[key] = {segment, to.pushBack(key, std::move(value))};
+    }
+
+    // Окно переполнено: его самый старый элемент либо допускается в основную часть, либо вытесняется
+    void admitFromWindow() {
+        if (probation.size() + protectedList.size() < mainCapacity) {
+            transfer(window, probation, Probation);
+            return;
+        }
+        if (mainCapacity == 0) {
+            evictFrom(window);
+            return;
+        }
+        List& victimList = probation.empty() ? protectedList : probation;
+        const Key& candidate = window.key(window.front());
+        const Key& victim = victimList.key(victimList.front());
+        if (sketch.estimate(candidate) > sketch.estimate(victim)) {
+            evictFrom(victimList);
+            transfer(window, probation, Probation);
+        } else {
+            evictFrom(window);
+        }
+    }
+
+    // Обращение к элементу, уже находящемуся в кэше. Возвращает новое положение элемента
+    Location onHit(const Key& key, const Location& location) {
+        switch (location.segment) {
+            case Window:
+                window.moveToBack(location.index);
+                return location;
+            case Protected:
+                protectedList.moveToBack(location.index);
+                return location;
+            default: {
+                Value value = std::move(probation.value(location.index));
+                probation.remove(location.index);
+                locations[key] = {Protected, protectedList.pushBack(key, std::move(value))};
+                if (protectedList.size() > protectedCapacity) {
+                    transfer(protectedList, probation, Probation); // Понижаем самый старый защищённый
+                }
+                return locations.get(key);
+            }
+        }
+    }
+
+public:
+    explicit WTinyLFUCache(size_t capacity)
+        : capacity_(capacity),
+          windowCapacity(capacity / 100 == 0 ? 1 : capacity / 100),
+          sketch(capacity) {
+        mainCapacity = capacity_ > windowCapacity ? capacity_ - windowCapacity : 0;
+        protectedCapacity = mainCapacity * 4 / 5;
+    }
+
+    void access(const Key& key, const Value& value) override {
+        sketch.increment(key);
+        if (const Location* found = locations.find(key)) {
+            Location location = *found;
+            listOf(location.segment).value(location.index) = value;
+            onHit(key, location);
+            return;
+        }
+        if (capacity_ == 0) {
+            return;
+        }
+        locations.add(key, {Window, window.pushBack(key, value)});
+        if (window.size() > windowCapacity) {
+            admitFromWindow();
+        }
+    }
+
+    bool contains(const Key& key) const override {
+        return locations.contains_key(key);
+    }
+
+    Value& get(const Key& key) override {
+        Value* value = find(key);
+        if (!value) {
+            throw std::runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    const Value& get(const Key& key) const override {
+        const Location* location = locations.find(key);
+        if (!location) {
+            throw std::runtime_error("Key not found");
+        }
+        switch (location->segment) {
+            case Window: return window.value(location->index);
+            case Probation: return probation.value(location->index);
+            default: return protectedList.value(location->index);
+        }
+    }
+
+    Value* find(const Key& key) override {
+        sketch.increment(key); // Промахи тоже учитываются - так ключ быстрее пройдёт фильтр допуска
+        const Location* found = locations.find(key);
+        if (!found) {
+            return nullptr;
+        }
+        Location location = onHit(key, *found);
+        return &listOf(location.segment).value(location.index);
+    }
+
+    size_t size() const override {
+        return window.size() + probation.size() + protectedList.size();
+    }
+
+    void print() const override {
+        const List* lists[] = {&window, &probation, &protectedList};
+        const char* names[] = {"window", "probation", "protected"};
+        for (int s = 0; s < 3; ++s) {
+            std::cout << "Cache contents (" << names[s] << "):\n";
+            for (size_t i = lists[s]->front(); i != List::npos; i = lists[s]->next(i)) {
+                std::cout << "Key: " << lists[s]->key(i) << ", Value: " << lists[s]->value(i) << "\n";
+            }
+        }
+    }
+
+    void clear() override {
+        window.clear();
+        probation.clear();
+        protectedList.clear();
+        locations.clear();
+        sketch.clear();
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+};
+
+#endif //L3_WTINYLFUCACHE_H
@@ -8,7 +8,8 @@ bool menu_vfs(VirtualFileSystem& vfs){
     std::cout << "3. Delete directory" << std::endl;
     std::cout << "4. Delete file" << std::endl;
     std::cout << "5. Print file system" << std::endl;
-    std::cout << "6. Exit" << std::endl;
+    std::cout << "6. Read file" << std::endl;
+    std::cout << "7. Exit" << std::endl;
     int choice;
     std::cin >> choice;
     switch(choice){
@@ -85,6 +86,25 @@ bool menu_vfs(VirtualFileSystem& vfs){
         }
 
         case 6:{
+            std::string path;
+            std::cout << "Enter path to file: ";
+            std::cin >> path;
+            uint64_t offset;
+            std::cout << "Enter offset: ";
+            std::cin >> offset;
+            size_t length;
+            std::cout << "Enter length: ";
+            std::cin >> length;
+            try {
+                std::cout << vfs.readFile(path, offset, length) << std::endl;
+            }
+            catch (std::runtime_error& e) {
+                std::cout << "Couldn't read file. Error: " << e.what() << std::endl;
+            }
+            return true;
+        }
+
+        case 7:{
             return false;
         }
 
@@ -118,12 +138,12 @@ bool menu_cache(LRUCache<std::string, std::string>& cache){
             std::string key;
             std::cout << "Enter key: ";
             std::cin >> key;
-            try {
-                cache.access(key, cache.get(key));
-                std::cout << "Value: " << cache.get(key) << std::endl;
+            std::string* value = cache.find(key); // Один поиск, заодно помечает элемент как использованный
+            if (value) {
+                std::cout << "Value: " << *value << std::endl;
             }
-            catch (std::runtime_error& e) {
-                std::cout << "Key not found. Error: " << e.what() << std::endl;
+            else {
+                std::cout << "Key not found" << std::endl;
             }
             return true;
         }
@@ -1,6 +1,19 @@
 #include "gtest/gtest.h"
 #include "../VirtualFileSystem.h"
 #include "../LRUCache.h"
+#include "../ShardedLRUCache.h"
+#include "../ClockCache.h"
+#include "../TwoQueueCache.h"
+#include "../ARCCache.h"
+#include "../WTinyLFUCache.h"
+#include "../CountMinSketch.h"
+#include "../LoadingCache.h"
+#include "../ConcurrentDictionary.h"
+#include "../SmallDictionary.h"
+#include "../Set.h"
+#include <atomic>
+#include <vector>
+#include <thread>
 
 TEST(AVLTree, Insert) {
     AVLTree<int> tree;
@@ -294,6 +307,288 @@ TEST_F(VirtualFileSystemTest, PerformanceTest) {
               << " ms" << std::endl;
 }
 
+// Кэш путей: разные записи одного пути, отсутствующие пути и их сброс при изменениях
+TEST_F(VirtualFileSystemTest, PathCache) {
+    std::ofstream(testFilesDir + "/file1") << "hello";
+    VirtualFileSystem vfs;
+    vfs.addDirectory("/", "a");
+    vfs.addDirectory("/a", "b");
+    vfs.addFile("/a/b", testFilesDir + "/file1", "c.txt");
+
+    EXPECT_EQ(vfs.readFile("/a/b/c.txt", 0, 5), "hello");
+    EXPECT_EQ(vfs.readFile("a//b/c.txt", 0, 5), "hello");
+    EXPECT_THROW(vfs.addFile("/a/b/", testFilesDir + "/file1", "c.txt"), std::runtime_error);
+
+    EXPECT_THROW(vfs.readFile("/a/b/d.txt", 0, 5), std::runtime_error); // Запоминается как отсутствующий
+    vfs.addFile("/a//b", testFilesDir + "/file1", "d.txt");
+    EXPECT_EQ(vfs.readFile("/a/b/d.txt", 0, 5), "hello");
+
+    vfs.removeFile("/a/b", "c.txt");
+    EXPECT_THROW(vfs.readFile("/a/b/c.txt", 0, 5), std::runtime_error);
+    vfs.removeFile("/a/b", "d.txt");
+    vfs.removeDirectory("/a", "b");
+    EXPECT_THROW(vfs.addFile("/a/b", testFilesDir + "/file1", "c.txt"), std::runtime_error);
+    vfs.addDirectory("/a", "b");
+    vfs.addFile("/a/b", testFilesDir + "/file1", "c.txt");
+    EXPECT_EQ(vfs.readFile("/a/b/c.txt", 1, 3), "ell");
+}
+
+// Чтение одних и тех же файлов из нескольких потоков
+TEST_F(VirtualFileSystemTest, ConcurrentReadFile) {
+    VirtualFileSystem vfs(1 << 20, 16);
+    for (int i = 1; i <= 20; i++) {
+        std::ofstream(testFilesDir + "/file" + std::to_string(i)) << "content of file " << i;
+        vfs.addDirectory("/", "d" + std::to_string(i));
+        vfs.addFile("/d" + std::to_string(i), testFilesDir + "/file" + std::to_string(i), "f");
+    }
+
+    std::atomic<int> errors(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; i++) {
+                int n = (i * 7 + t) % 20 + 1;
+                std::string expected = "content of file " + std::to_string(n);
+                if (vfs.readFile("/d" + std::to_string(n) + "/f", 0, 100) != expected) {
+                    ++errors;
+                }
+                try {
+                    vfs.readFile("/d" + std::to_string(n) + "/missing" + std::to_string(i % 50), 0, 10);
+                    ++errors;
+                } catch (const std::runtime_error&) {
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(errors, 0);
+}
+
+// Чтение содержимого файлов через кэш блоков
+TEST_F(VirtualFileSystemTest, ReadFile) {
+    std::string content;
+    for (int i = 0; i < 100; i++) {
+        content += static_cast<char>('a' + i % 26);
+    }
+    std::ofstream(testFilesDir + "/file1") << content;
+
+    VirtualFileSystem vfs(1024, 16); // Блоки по 16 байт
+    vfs.addDirectory("/", "docs");
+    vfs.addFile("/docs", testFilesDir + "/file1", "a.txt");
+    vfs.addFile("/docs", testFilesDir + "/file1", "b.txt"); // Тот же реальный файл
+
+    EXPECT_EQ(vfs.readFile("/docs/a.txt", 10, 30), content.substr(10, 30));
+    EXPECT_EQ(vfs.cache().diskReads(), 3); // Блоки 0, 1 и 2
+    EXPECT_EQ(vfs.readFile("/docs/b.txt", 12, 20), content.substr(12, 20));
+    EXPECT_EQ(vfs.cache().diskReads(), 3); // Повторное чтение - только из памяти
+
+    EXPECT_EQ(vfs.readFile("/docs/a.txt", 90, 50), content.substr(90)); // Обрезается по концу файла
+    size_t blocks = vfs.cache().blocksCached();
+    EXPECT_EQ(vfs.readFile("/docs/a.txt", 200, 10), "");
+    EXPECT_EQ(vfs.readFile("/docs/a.txt", 100000, 10), "");
+    EXPECT_EQ(vfs.cache().blocksCached(), blocks); // Чтение за концом файла не добавляет пустых блоков
+    EXPECT_EQ(vfs.readFile("/docs/a.txt", 0, 100), content);
+
+    EXPECT_THROW(vfs.readFile("/docs", 0, 10), std::runtime_error);
+    EXPECT_THROW(vfs.readFile("/docs/missing.txt", 0, 10), std::runtime_error);
+    vfs.addFile("/docs", testFilesDir + "/no_such_file", "broken.txt");
+    EXPECT_THROW(vfs.readFile("/docs/broken.txt", 0, 10), std::runtime_error);
+}
+
+// Чтение без копирования через отображение файла в память
+TEST_F(VirtualFileSystemTest, ReadView) {
+    std::string content(10000, 'x');
+    content += "tail";
+    std::ofstream(testFilesDir + "/file2") << content;
+
+    VirtualFileSystem vfs(1024, 16, 1); // Держим не больше одного отображения
+    vfs.addFile("/", testFilesDir + "/file2", "big.bin");
+    vfs.addFile("/", testFilesDir + "/file3", "empty.bin");
+
+    FileView tail = vfs.readView("/big.bin", 10000, 100, AccessPattern::Random);
+    EXPECT_EQ(tail.view(), "tail");
+    FileView head = vfs.readView("/big.bin", 0, 3);
+    EXPECT_EQ(std::string_view(head), "xxx");
+    EXPECT_EQ(vfs.readView("/big.bin", 20000, 10).size(), 0);
+    EXPECT_EQ(vfs.cache().diskReads(), 0); // Кэш блоков не используется
+
+    // Отображение вытеснено из кэша, но участок остаётся доступным
+    EXPECT_TRUE(vfs.readView("/empty.bin", 0, 10).empty());
+    EXPECT_EQ(tail.view(), "tail");
+
+    EXPECT_THROW(vfs.readView("/", 0, 10), std::runtime_error);
+}
+
+// Упреждающее чтение при последовательном доступе
+TEST_F(VirtualFileSystemTest, ReadAhead) {
+    std::string content;
+    for (int i = 0; i < 1024; i++) {
+        content += static_cast<char>('a' + i % 26);
+    }
+    std::ofstream(testFilesDir + "/file1") << content;
+
+    VirtualFileSystem vfs(1 << 20, 16); // 64 блока по 16 байт
+    vfs.enableReadAhead(2, 256); // Окно до 16 блоков
+    vfs.addFile("/", testFilesDir + "/file1", "stream.txt");
+
+    std::string read;
+    for (int i = 0; i < 4; i++) {
+        read += vfs.readFile("/stream.txt", i * 16, 16);
+    }
+    vfs.waitForReadAhead();
+    size_t diskReads = vfs.cache().diskReads();
+    EXPECT_GT(diskReads, 4); // Следующие блоки загружены заранее
+    read += vfs.readFile("/stream.txt", 64, 64);
+    EXPECT_EQ(vfs.cache().diskReads(), diskReads); // И читаются уже из кэша
+
+    while (read.size() < content.size()) {
+        read += vfs.readFile("/stream.txt", read.size(), 100);
+    }
+    EXPECT_EQ(read, content);
+    vfs.waitForReadAhead();
+    EXPECT_EQ(vfs.cache().diskReads(), 64); // Каждый блок прочитан с диска ровно один раз
+}
+
+// Пакетная загрузка начала многих файлов
+TEST_F(VirtualFileSystemTest, Preload) {
+    VirtualFileSystem vfs(1 << 20, 16);
+    ArraySequence<std::string> paths;
+    for (int i = 1; i <= 50; i++) {
+        std::ofstream(testFilesDir + "/file" + std::to_string(i)) << "content of file " << i;
+        vfs.addFile("/", testFilesDir + "/file" + std::to_string(i), "f" + std::to_string(i));
+        paths.append("/f" + std::to_string(i));
+    }
+
+    EXPECT_EQ(vfs.preload(paths, 32), 100); // По два блока на файл
+    EXPECT_EQ(vfs.preload(paths, 32), 0); // Всё уже в кэше
+    EXPECT_EQ(vfs.preload(paths, 64), 0); // Блоки за концом файлов не читаются
+    EXPECT_EQ(vfs.cache().blocksCached(), 100); // И не занимают кэш пустыми записями
+    size_t diskReads = vfs.cache().diskReads();
+    EXPECT_EQ(vfs.readFile("/f7", 0, 32), "content of file 7");
+    EXPECT_EQ(vfs.readFile("/f42", 11, 5), "file ");
+    EXPECT_EQ(vfs.cache().diskReads(), diskReads);
+
+    paths.append("/missing");
+    EXPECT_THROW(vfs.preload(paths), std::runtime_error);
+}
+
+// Файлов в пачке больше, чем доступных дескрипторов
+TEST_F(VirtualFileSystemTest, PreloadManyFiles) {
+    VirtualFileSystem vfs(1 << 20, 16);
+    ArraySequence<std::string> paths;
+    for (int i = 1; i <= 300; i++) {
+        std::ofstream(testFilesDir + "/file" + std::to_string(i)) << "file " << i;
+        vfs.addFile("/", testFilesDir + "/file" + std::to_string(i), "f" + std::to_string(i));
+        paths.append("/f" + std::to_string(i));
+    }
+    vfs.addFile("/", testFilesDir + "/no_such_file", "broken");
+
+    rlimit saved;
+    ASSERT_EQ(::getrlimit(RLIMIT_NOFILE, &saved), 0);
+    rlimit reduced = saved;
+    reduced.rlim_cur = 64;
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &reduced), 0);
+    size_t fetched = vfs.preload(paths, 16);
+    paths.append("/broken");
+    EXPECT_THROW(vfs.preload(paths, 16), std::runtime_error); // Ошибка открытия не замалчивается
+    ::setrlimit(RLIMIT_NOFILE, &saved);
+
+    EXPECT_EQ(fetched, 300);
+    EXPECT_EQ(vfs.readFile("/f299", 0, 16), "file 299");
+}
+
+// Обе реализации асинхронного чтения дают одинаковый результат
+TEST_F(VirtualFileSystemTest, AsyncReaders) {
+    std::string content;
+    for (int i = 0; i < 4096; i++) {
+        content += static_cast<char>('a' + i % 26);
+    }
+    std::ofstream(testFilesDir + "/file1") << content;
+    int fd = ::open((testFilesDir + "/file1").c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+
+    auto check = [&](IAsyncReader& io) {
+        char buffers[64][64];
+        size_t done = 0;
+        for (int i = 0; i < 64; i++) {
+            io.read(fd, buffers[i], 64, i * 64, [&, i](ssize_t result) {
+                EXPECT_EQ(result, 64);
+                EXPECT_EQ(std::string(buffers[i], 64), content.substr(i * 64, 64));
+                ++done;
+            });
+        }
+        io.wait();
+        EXPECT_EQ(done, 64);
+        EXPECT_EQ(io.inFlight(), 0);
+
+        ssize_t pastEnd = -1;
+        io.read(fd, buffers[0], 64, 10000, [&](ssize_t result) { pastEnd = result; });
+        io.wait();
+        EXPECT_EQ(pastEnd, 0);
+    };
+
+    ThreadPoolReader pool(4);
+    check(pool);
+#ifdef L3_HAS_IO_URING
+    if (UringReader::supported()) {
+        UringReader uring(16); // Меньше запросов, чем ставится: очередь освобождается по ходу
+        check(uring);
+
+        // Короткое чтение (из канала пришла только часть данных) дочитывается до конца
+        int pipeFds[2];
+        ASSERT_EQ(::pipe(pipeFds), 0);
+        ASSERT_EQ(::write(pipeFds[1], "0123456789", 10), 10);
+        char piped[20];
+        ssize_t pipedResult = -1;
+        uring.read(pipeFds[0], piped, 20, 0, [&](ssize_t r) { pipedResult = r; });
+        uring.submit();
+        std::thread writer([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            EXPECT_EQ(::write(pipeFds[1], "abcdefghij", 10), 10);
+        });
+        uring.wait();
+        writer.join();
+        ::close(pipeFds[0]);
+        ::close(pipeFds[1]);
+        EXPECT_EQ(pipedResult, 20);
+        EXPECT_EQ(std::string(piped, 20), "0123456789abcdefghij");
+
+        char registered[2][128];
+        uring.registerBuffers(registered, 128, 2);
+        ssize_t result = -1;
+        uring.readFixed(fd, registered[1], 128, 26, 1, [&](ssize_t r) { result = r; });
+        uring.wait();
+        EXPECT_EQ(result, 128);
+        EXPECT_EQ(std::string(registered[1], 128), content.substr(26, 128));
+    }
+#endif
+    ::close(fd);
+}
+
+TEST(ReadAhead, AdaptiveWindow) {
+    BlockCache cache(1 << 20, 16);
+    ReadAhead readAhead(cache, 1, 16);
+    const std::string path = "no_such_file"; // Ошибки фоновой загрузки не влияют на читателя
+
+    readAhead.onRead(path, 0, 16);
+    EXPECT_EQ(readAhead.window(path), 4);
+    readAhead.onRead(path, 16, 16);
+    EXPECT_EQ(readAhead.window(path), 8);
+    readAhead.onRead(path, 32, 16);
+    readAhead.onRead(path, 48, 16);
+    EXPECT_EQ(readAhead.window(path), 16); // Не больше максимума
+
+    readAhead.onRead(path, 500, 16); // Произвольный доступ
+    EXPECT_EQ(readAhead.window(path), 4);
+    readAhead.onRead(path, 100, 16);
+    EXPECT_EQ(readAhead.window(path), 1);
+    readAhead.onRead(path, 116, 16);
+    EXPECT_EQ(readAhead.window(path), 2);
+    readAhead.wait();
+}
+
 
 // Тестовый класс для работы с LRUCache
 class LRUCacheTest : public ::testing::Test {
@@ -367,6 +662,20 @@ TEST_F(LRUCacheTest, LRUBehavior) {
     cache->print(); // Вывод в консоль для проверки
 }
 
+// Тест удаления по ключу
+TEST_F(LRUCacheTest, Remove) {
+    cache->access(1, "one");
+    cache->access(2, "two");
+    EXPECT_TRUE(cache->remove(1));
+    EXPECT_FALSE(cache->remove(1));
+    EXPECT_FALSE(cache->contains(1));
+    EXPECT_EQ(cache->size(), 1);
+
+    cache->access(3, "three");
+    cache->access(4, "four"); // Места хватает, элемент 2 не вытесняется
+    EXPECT_TRUE(cache->contains(2));
+}
+
 // Тест производительности
 TEST_F(LRUCacheTest, PerformanceTest) {
     std::srand(std::time(nullptr));
@@ -388,3 +697,1019 @@ TEST_F(LRUCacheTest, PerformanceTest) {
         cache->clear();
     }
 }
+
+// Тест порядка вытеснения на большом кэше (узлы списка переиспользуются после вытеснения)
+TEST(LRUCache, EvictionOrderWithReusedNodes) {
+    LRUCache<int, std::string> cache(100);
+    for (int i = 0; i < 100; i++) {
+        cache.access(i, "value" + std::to_string(i));
+    }
+    // Обращаемся к чётным ключам, теперь самыми старыми становятся нечётные
+    for (int i = 0; i < 100; i += 2) {
+        EXPECT_EQ(cache.get(i), "value" + std::to_string(i));
+    }
+    for (int i = 100; i < 150; i++) {
+        cache.access(i, "value" + std::to_string(i));
+    }
+    EXPECT_EQ(cache.size(), 100);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(cache.contains(i), i % 2 == 0);
+    }
+    for (int i = 100; i < 150; i++) {
+        EXPECT_TRUE(cache.contains(i));
+    }
+
+    // После очистки пул узлов остаётся, а порядок строится заново
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.contains(120));
+    for (int i = 0; i < 100; i++) {
+        cache.access(i, "again" + std::to_string(i));
+    }
+    EXPECT_EQ(cache.get(0), "again0");
+    cache.access(1000, "new");
+    EXPECT_TRUE(cache.contains(0));
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_EQ(cache.size(), 100);
+}
+
+// Тест распределения ёмкости по шардам и базовых операций
+TEST(ShardedLRUCache, CapacitySplit) {
+    ShardedLRUCache<int, std::string> cache(10, 4);
+    EXPECT_EQ(cache.shardCount(), 4);
+    EXPECT_EQ(cache.capacity(), 10);
+    for (int i = 0; i < 1000; i++) {
+        cache.access(i, "value" + std::to_string(i));
+    }
+    EXPECT_LE(cache.size(), 10);
+    cache.access(5000, "last");
+    EXPECT_TRUE(cache.contains(5000));
+    EXPECT_EQ(cache.get_copy(5000), "last");
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_THROW((ShardedLRUCache<int, int>(10, 0)), std::invalid_argument);
+}
+
+// Ёмкость меньше числа шардов: шардов становится столько, сколько элементов, и каждый ключ кэшируется
+TEST(ShardedLRUCache, SmallCapacity) {
+    ShardedLRUCache<int, int> cache(3, 16);
+    EXPECT_EQ(cache.shardCount(), 3);
+    for (int i = 0; i < 100; i++) {
+        cache.access(i, i);
+        EXPECT_TRUE(cache.contains(i));
+        EXPECT_EQ(cache.get_copy(i), i);
+    }
+    EXPECT_LE(cache.size(), 3);
+
+    ShardedLRUCache<int, int> single(1);
+    EXPECT_EQ(single.shardCount(), 1);
+    single.access(5, 50);
+    EXPECT_TRUE(single.contains(5));
+}
+
+// Тест одновременной работы нескольких потоков с кэшем
+TEST(ShardedLRUCache, ConcurrentAccess) {
+    const int threadCount = 8;
+    const int keysPerThread = 2000;
+    ShardedLRUCache<int, int> cache(2 * threadCount * keysPerThread, 8); // С запасом, чтобы не было вытеснений
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&cache, t, keysPerThread]() {
+            for (int i = 0; i < keysPerThread; i++) {
+                int key = t * keysPerThread + i;
+                cache.access(key, key * 2);
+                EXPECT_EQ(cache.get_copy(key), key * 2);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(cache.size(), threadCount * keysPerThread);
+}
+
+// Тест второго шанса: элемент с выставленным битом обращения переживает вытеснение
+TEST(ClockCache, SecondChance) {
+    ClockCache<int, std::string> cache(3);
+    cache.access(1, "one");
+    cache.access(2, "two");
+    cache.access(3, "three");
+    EXPECT_EQ(cache.get(1), "one");
+
+    cache.access(4, "four");
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_TRUE(cache.contains(4));
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_THROW(cache.get(2), std::runtime_error);
+}
+
+// Тест параллельных чтений
+TEST(ClockCache, ConcurrentReads) {
+    ClockCache<int, int> cache(1000);
+    for (int i = 0; i < 1000; i++) {
+        cache.access(i, i * 3);
+    }
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 8; t++) {
+        readers.emplace_back([&cache]() {
+            for (int i = 0; i < 1000; i++) {
+                EXPECT_EQ(cache.get(i), i * 3);
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(cache.size(), 1000);
+}
+
+// Тест сегментов: ёмкость делится между сегментами, параллельные вставки и чтения
+// разных ключей не теряют данные и не превышают ёмкость
+TEST(ClockCache, Segments) {
+    ClockCache<int, int> cache(400, 4);
+    EXPECT_EQ(cache.segmentCount(), 4);
+    EXPECT_EQ((ClockCache<int, int>::defaultSegmentCount(3)), 1);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < 2000; i++) {
+                int key = t * 100000 + i;
+                cache.access(key, key * 2);
+                int value = 0;
+                if (cache.try_get(key, value)) {
+                    EXPECT_EQ(value, key * 2);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(cache.size(), 400);
+    EXPECT_GT(cache.size(), 300);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    cache.access(7, 14);
+    EXPECT_EQ(cache.get(7), 14);
+}
+
+// Попадания без блокировок: читатели копируют значение горячего ключа, пока писатель
+// заменяет его и вытесняет соседей; заменённые элементы освобождаются после чтения
+TEST(ClockCache, LockFreeHitsDuringUpdates) {
+    ClockCache<int, std::string> cache(128, 2);
+    cache.access(0, std::string(64, 'a'));
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&]() {
+            std::string value;
+            while (!done) {
+                ASSERT_TRUE(cache.try_get(0, value)); // Горячий ключ всегда получает второй шанс
+                ASSERT_EQ(value, std::string(64, value[0]));
+            }
+        });
+    }
+    for (int i = 1; i < 5000; i++) {
+        cache.access(0, std::string(64, 'a' + i % 26));
+        cache.access(i, "cold");
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(cache.size(), 128);
+    EXPECT_TRUE(cache.contains(0));
+    reclamation::reclaim();
+    EXPECT_EQ(reclamation::pending(), 0u);
+}
+
+// Рабочая нагрузка: горячие ключи, к которым обращаются вперемешку с редкими,
+// затем однократный проход по большому числу новых ключей
+void runScanWorkload(ICache<int, std::string>& cache) {
+    for (int round = 0; round < 10; round++) {
+        for (int hot = 0; hot < 20; hot++) {
+            if (cache.contains(hot)) {
+                cache.get(hot);
+            } else {
+                cache.access(hot, "hot" + std::to_string(hot));
+            }
+        }
+        for (int i = 0; i < 30; i++) {
+            int cold = 100000 + round * 30 + i;
+            cache.access(cold, "cold" + std::to_string(cold));
+        }
+    }
+    for (int scan = 1000; scan < 3000; scan++) {
+        cache.access(scan, "scan" + std::to_string(scan));
+    }
+}
+
+// Тест устойчивости к однократному проходу для 2Q, ARC и W-TinyLFU
+TEST(ScanResistantCache, HotSetSurvivesScan) {
+    TwoQueueCache<int, std::string> twoQueue(100);
+    ARCCache<int, std::string> arc(100);
+    WTinyLFUCache<int, std::string> tinyLfu(100);
+    ICache<int, std::string>* caches[] = {&twoQueue, &arc, &tinyLfu};
+
+    for (ICache<int, std::string>* cache : caches) {
+        runScanWorkload(*cache);
+        EXPECT_LE(cache->size(), 100);
+        for (int hot = 0; hot < 20; hot++) {
+            ASSERT_TRUE(cache->contains(hot));
+            EXPECT_EQ(cache->get(hot), "hot" + std::to_string(hot));
+        }
+    }
+
+    // Для сравнения: обычный LRU-кэш теряет горячие ключи
+    LRUCache<int, std::string> lru(100);
+    runScanWorkload(lru);
+    EXPECT_FALSE(lru.contains(0));
+}
+
+// Тест базовых операций новых политик вытеснения
+TEST(ScanResistantCache, BasicOperations) {
+    TwoQueueCache<int, std::string> twoQueue(3);
+    ARCCache<int, std::string> arc(3);
+    WTinyLFUCache<int, std::string> tinyLfu(3);
+    ICache<int, std::string>* caches[] = {&twoQueue, &arc, &tinyLfu};
+
+    for (ICache<int, std::string>* cache : caches) {
+        cache->access(1, "one");
+        cache->access(2, "two");
+        EXPECT_EQ(cache->get(1), "one");
+        cache->access(1, "uno");
+        EXPECT_EQ(cache->get(1), "uno");
+        for (int i = 10; i < 20; i++) {
+            cache->access(i, "x");
+        }
+        EXPECT_EQ(cache->size(), 3);
+        EXPECT_THROW(cache->get(12345), std::runtime_error);
+        cache->clear();
+        EXPECT_EQ(cache->size(), 0);
+        EXPECT_FALSE(cache->contains(1));
+    }
+}
+
+// Счётчики упакованы по два в байт: соседние не влияют друг на друга, насыщаются на 15 и стареют
+TEST(CountMinSketch, PackedCounters) {
+    CountMinSketch<int> sketch(64);
+    for (int i = 0; i < 20; i++) {
+        sketch.increment(1);
+    }
+    for (int i = 0; i < 3; i++) {
+        sketch.increment(2);
+    }
+    EXPECT_EQ(sketch.estimate(1), 15);
+    EXPECT_GE(sketch.estimate(2), 3);
+    EXPECT_LT(sketch.estimate(2), 15);
+    for (int key = 1000; key < 1010; key++) {
+        EXPECT_LT(sketch.estimate(key), 15);
+    }
+
+    // Старение после 10 * 64 увеличений делит все счётчики пополам
+    for (int i = 0; i < 640; i++) {
+        sketch.increment(100000 + i);
+    }
+    EXPECT_LE(sketch.estimate(1), 8);
+    EXPECT_GE(sketch.estimate(1), 7);
+
+    sketch.clear();
+    EXPECT_EQ(sketch.estimate(1), 0);
+}
+
+// Тест ограничения кэша по суммарному размеру значений в байтах
+TEST(LRUCache, ByteBudget) {
+    LRUCache<int, std::string> cache(LRUCache<int, std::string>::unlimited, 10);
+    cache.access(1, "aaaa");
+    cache.access(2, "bbbb");
+    EXPECT_EQ(cache.weight(), 8);
+
+    // Для нового элемента вытесняется столько старых, сколько нужно
+    cache.access(3, "cccccc");
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_EQ(cache.weight(), 10);
+
+    // Увеличение значения существующего ключа тоже вытесняет старые элементы
+    cache.access(3, "ccccccccc");
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_EQ(cache.weight(), 9);
+
+    // Элемент больше всего бюджета отклоняется, старое значение по ключу удаляется
+    cache.access(3, "this value does not fit");
+    EXPECT_FALSE(cache.contains(3));
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.weight(), 0);
+}
+
+// Тест пользовательской функции веса
+TEST(LRUCache, CustomWeigher) {
+    auto weigher = [](const int& value) { return static_cast<size_t>(value); };
+    LRUCache<int, int, decltype(weigher)> cache(2, 100, weigher);
+    cache.access(1, 60);
+    cache.access(2, 30);
+    cache.access(3, 5); // Ограничение по количеству элементов продолжает действовать
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_EQ(cache.weight(), 35);
+}
+
+// Значение, которое считает свои копирования
+struct CopyCounter {
+    static int copies;
+    std::string payload;
+
+    CopyCounter() = default;
+    explicit CopyCounter(std::string payload) : payload(std::move(payload)) {}
+    CopyCounter(const CopyCounter& other) : payload(other.payload) { copies++; }
+    CopyCounter(CopyCounter&&) noexcept = default;
+    CopyCounter& operator=(const CopyCounter& other) {
+        payload = other.payload;
+        copies++;
+        return *this;
+    }
+    CopyCounter& operator=(CopyCounter&&) noexcept = default;
+
+    friend std::ostream& operator<<(std::ostream& out, const CopyCounter& value) {
+        return out << value.payload;
+    }
+};
+
+int CopyCounter::copies = 0;
+
+// Тест вставки с перемещением: значение не копируется ни в кэше, ни при перехэшировании словаря
+TEST(LRUCache, MoveAwareInsertion) {
+    LRUCache<int, CopyCounter> cache(1000);
+    CopyCounter::copies = 0;
+    for (int i = 0; i < 500; i++) {
+        cache.insert(int(i), CopyCounter(std::string(1000, 'x')));
+    }
+    cache.emplace(500, std::string(1000, 'y'));
+    CopyCounter& loaded = cache.get_or_load(501, []() { return CopyCounter("loaded"); });
+    EXPECT_EQ(loaded.payload, "loaded");
+    EXPECT_EQ(cache.get_or_load(501, []() { return CopyCounter("not called"); }).payload, "loaded");
+    EXPECT_EQ(cache.get(500).payload, std::string(1000, 'y'));
+    EXPECT_EQ(CopyCounter::copies, 0);
+
+    Dictionary<int, CopyCounter> dict;
+    for (int i = 0; i < 500; i++) {
+        dict.add(int(i), CopyCounter("value"));
+    }
+    dict.remove(10);
+    EXPECT_EQ(dict.count(), 499);
+    EXPECT_EQ(CopyCounter::copies, 0);
+}
+
+// Хэш с явными коллизиями: домашняя ячейка - key % 64, фрагмент всегда 0.
+// is_avalanching не даёт словарю перемешать его
+struct CollidingHash {
+    using is_avalanching = void;
+
+    size_t operator()(int key) const {
+        return static_cast<size_t>(key % 64) << 7;
+    }
+};
+
+// Удаления из середины цепочки коллизий не должны терять ключи за ней
+TEST(Dictionary, RemoveKeepsProbeChains) {
+    Dictionary<int, int, CollidingHash> dict(64);
+    for (int i = 0; i < 8; i++) {
+        dict.add(i * 64, i); // Все ключи попадают в одну домашнюю ячейку 0
+    }
+    dict.add(1, 100); // Домашняя ячейка 1 занята цепочкой, ключ уезжает дальше
+    dict.remove(3 * 64); // Из середины цепочки
+    for (int i = 0; i < 8; i++) {
+        if (i != 3) {
+            ASSERT_EQ(dict.get(i * 64), i);
+        }
+    }
+    dict.remove(0); // Из начала цепочки
+    EXPECT_EQ(dict.count(), 7);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(dict.contains_key(i * 64), i != 0 && i != 3);
+    }
+    for (int i : {1, 2, 4, 5, 6, 7}) {
+        EXPECT_EQ(dict.get(i * 64), i);
+    }
+    EXPECT_EQ(dict.get(1), 100);
+
+    // Чередование вставок и удалений не должно терять и дублировать ключи
+    Dictionary<int, int> churn;
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 100; i++) {
+            churn.add(round * 100 + i, i);
+        }
+        for (int i = 0; i < 100; i += 2) {
+            churn.remove(round * 100 + i);
+        }
+    }
+    EXPECT_EQ(churn.count(), 50 * 50);
+    for (int key = 0; key < 5000; key++) {
+        ASSERT_EQ(churn.contains_key(key), key % 2 == 1);
+    }
+}
+
+// Размер таблицы - степень двойки, обход идёт только по заполненным ячейкам
+TEST(Dictionary, GrowthAndIteration) {
+    Dictionary<std::string, int> dict(20);
+    EXPECT_EQ(dict.capacity(), 32);
+    for (int i = 0; i < 1000; i++) {
+        dict.add("key" + std::to_string(i), i);
+    }
+    EXPECT_EQ(dict.count(), 1000);
+    EXPECT_EQ(dict.capacity() & (dict.capacity() - 1), 0);
+    EXPECT_GE(dict.capacity() * 7, dict.count() * 8);
+
+    long sum = 0;
+    size_t visited = 0;
+    for (const auto& entry : dict) {
+        EXPECT_EQ(entry.key, "key" + std::to_string(entry.value));
+        sum += entry.value;
+        visited++;
+    }
+    EXPECT_EQ(visited, 1000);
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+    EXPECT_EQ(dict.keys().getLength(), 1000);
+}
+
+// Во время постепенного переноса ключи доступны и в старой, и в новой таблице
+TEST(Dictionary, IncrementalRehash) {
+    Dictionary<int, int> dict;
+    int next = 0;
+    while (!dict.rehashing()) {
+        dict.add(next, next);
+        next++;
+    }
+    size_t grownCapacity = dict.capacity();
+    for (int i = 0; i < next; i++) {
+        ASSERT_EQ(dict.get(i), i);
+    }
+    dict.remove(next - 1); // Мог ещё не переехать
+    dict.remove(0);
+    dict[1] = 100;
+
+    size_t visited = 0;
+    for (const auto& entry : dict) {
+        EXPECT_NE(entry.key, 0);
+        visited++;
+    }
+    EXPECT_EQ(visited, dict.count());
+
+    for (int i = 0; i < 1000; i++) {
+        dict.add(next + i, next + i);
+    }
+    EXPECT_FALSE(dict.rehashing());
+    EXPECT_GT(dict.capacity(), grownCapacity);
+    EXPECT_EQ(dict.count(), static_cast<size_t>(next - 2 + 1000));
+    EXPECT_EQ(dict.get(1), 100);
+    EXPECT_FALSE(dict.contains_key(0));
+    EXPECT_FALSE(dict.contains_key(next - 1));
+    for (int i = 2; i < next - 1; i++) {
+        ASSERT_EQ(dict.get(i), i);
+    }
+}
+
+// Поиск строковых ключей через string_view и с заранее посчитанным хэшем
+TEST(Dictionary, TransparentLookup) {
+    Dictionary<std::string, int> dict;
+    dict.add("alpha", 1);
+    dict.add("beta", 2);
+    std::string path = "/alpha/beta";
+    std::string_view alpha = std::string_view(path).substr(1, 5);
+    ASSERT_NE(dict.find(alpha), nullptr);
+    EXPECT_EQ(*dict.find(alpha), 1);
+    EXPECT_TRUE(dict.contains_key(std::string_view("beta")));
+    EXPECT_FALSE(dict.contains_key(std::string_view("gamma")));
+    EXPECT_EQ(dict.get("beta"), 2);
+    EXPECT_THROW(dict.get(std::string_view("gamma")), std::runtime_error);
+
+    auto key = dict.prehash("beta");
+    ASSERT_NE(dict.find(key), nullptr);
+    EXPECT_EQ(*dict.find(key), 2);
+    dict.remove(std::string_view("beta"));
+    EXPECT_EQ(dict.find(key), nullptr);
+    EXPECT_EQ(dict.count(), 1);
+}
+
+// Резервирование, коэффициент заполнения и сжатие
+TEST(Dictionary, ReserveAndShrink) {
+    Dictionary<int, int> dict;
+    dict.reserve(1000);
+    size_t reserved = dict.capacity();
+    EXPECT_GE(reserved * dict.maxLoadFactor(), 1000);
+    for (int i = 0; i < 1000; i++) {
+        dict.add(i, i);
+    }
+    EXPECT_EQ(dict.capacity(), reserved); // Вставки в пределах резерва не перестраивают таблицу
+    EXPECT_FALSE(dict.rehashing());
+
+    for (int i = 0; i < 990; i++) {
+        dict.remove(i);
+    }
+    EXPECT_EQ(dict.capacity(), reserved); // Ниже резерва автоматически не сжимается
+    dict.shrink_to_fit();
+    EXPECT_EQ(dict.capacity(), 16);
+    for (int i = 990; i < 1000; i++) {
+        ASSERT_EQ(dict.get(i), i);
+    }
+
+    // Без резерва таблица сжимается сама, когда почти опустела
+    for (int i = 0; i < 5000; i++) {
+        dict.add(i, i);
+    }
+    size_t peak = dict.capacity();
+    for (int i = 0; i < 4990; i++) {
+        dict.remove(i);
+    }
+    EXPECT_LT(dict.capacity(), peak / 8);
+    EXPECT_EQ(dict.count(), 10);
+
+    dict.setMaxLoadFactor(0.5);
+    EXPECT_LE(dict.count(), dict.capacity() / 2);
+    EXPECT_THROW(dict.setMaxLoadFactor(1.0), std::invalid_argument);
+
+    for (int i = 0; i < 5000; i++) {
+        dict.add(i, i);
+    }
+    dict.clear(); // Очистка возвращает память
+    EXPECT_EQ(dict.capacity(), 0); // Без резерва таблица освобождается целиком
+    EXPECT_EQ(dict.count(), 0);
+}
+
+TEST(Dictionary, ForEach) {
+    Dictionary<std::string, int> dict;
+    for (int i = 0; i < 100; i++) {
+        dict.add("key" + std::to_string(i), i);
+    }
+    dict.for_each([](const std::string&, int& value) { value *= 2; });
+
+    const Dictionary<std::string, int>& view = dict;
+    int sum = 0;
+    size_t visited = 0;
+    view.for_each([&](const std::string& key, const int& value) {
+        EXPECT_EQ(value, 2 * std::stoi(key.substr(3)));
+        sum += value;
+        visited++;
+    });
+    EXPECT_EQ(visited, 100);
+    EXPECT_EQ(sum, 2 * 99 * 100 / 2);
+}
+
+TEST(Dictionary, HashFunctions) {
+    DefaultHash<std::string> stringHash;
+    std::string path = "/usr/share/doc/readme.txt";
+    EXPECT_EQ(stringHash(path), stringHash(std::string_view(path)));
+    EXPECT_NE(stringHash("a"), stringHash("b"));
+    EXPECT_NE(stringHash(""), stringHash(std::string(1, '\0')));
+    EXPECT_NE(DefaultHash<std::string>(1)(path), DefaultHash<std::string>(2)(path));
+    EXPECT_EQ(DefaultHash<std::string>::seeded()(path), DefaultHash<std::string>::seeded()(path));
+
+    // Последовательные целые ключи должны расходиться по всей таблице
+    DefaultHash<int> intHash;
+    size_t buckets[16] = {};
+    for (int i = 0; i < 1600; i++) {
+        buckets[intHash(i) & 15]++;
+    }
+    for (size_t count : buckets) {
+        EXPECT_GT(count, 50);
+        EXPECT_LT(count, 150);
+    }
+
+    // Пользовательский хэш без is_avalanching перемешивается самой таблицей
+    Dictionary<int, int, std::hash<int>> identity;
+    Dictionary<std::string, int> seeded(DefaultHash<std::string>::seeded());
+    for (int i = 0; i < 1000; i++) {
+        identity.add(i * 1024, i);
+        seeded.add("file" + std::to_string(i), i);
+    }
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(identity.get(i * 1024), i);
+        ASSERT_EQ(*seeded.find(std::string_view("file" + std::to_string(i))), i);
+    }
+}
+
+TEST(Dictionary, BulkOperations) {
+    std::vector<std::pair<std::string, int>> manifest;
+    for (int i = 0; i < 1000; i++) {
+        manifest.emplace_back("file" + std::to_string(i), i);
+    }
+    Dictionary<std::string, int> dict;
+    dict.add("stale", -1);
+    dict.build_from(manifest.begin(), manifest.end());
+    EXPECT_EQ(dict.count(), 1000);
+    EXPECT_FALSE(dict.contains_key("stale"));
+    EXPECT_FALSE(dict.rehashing());
+
+    std::pair<std::string, int> more[] = {{"file0", 100}, {"extra", 5}};
+    dict.add_range(std::begin(more), std::end(more));
+    EXPECT_EQ(dict.count(), 1001);
+    EXPECT_EQ(dict.get("file0"), 100);
+
+    ArraySequence<std::string> keys;
+    keys.append("file1");
+    keys.append("missing");
+    keys.append("extra");
+    ArraySequence<int*> values;
+    EXPECT_EQ(dict.get_many(keys, values), 2);
+    ASSERT_EQ(values.getLength(), 3);
+    EXPECT_EQ(*values[0], 1);
+    EXPECT_EQ(values[1], nullptr);
+    EXPECT_EQ(*values[2], 5);
+}
+
+TEST(SmallDictionary, PromotionAndDemotion) {
+    SmallDictionary<std::string, int> dict;
+    EXPECT_EQ(dict.capacity(), 0);
+
+    dict.add("c", 3);
+    dict.add("a", 1);
+    dict.add("b", 2);
+    std::string order;
+    dict.for_each([&](const std::string& key, int) { order += key; });
+    EXPECT_EQ(order, "abc");
+    EXPECT_FALSE(dict.isLarge());
+    EXPECT_EQ(*dict.find(std::string_view("b")), 2);
+
+    for (int i = 0; i < 10; ++i) {
+        dict.add("key" + std::to_string(i), i);
+    }
+    EXPECT_TRUE(dict.isLarge());
+    EXPECT_EQ(dict.count(), 13);
+    EXPECT_EQ(*dict.find(std::string_view("key7")), 7);
+    dict["a"] = 10;
+    EXPECT_EQ(dict.get("a"), 10);
+
+    for (int i = 0; i < 10; ++i) {
+        dict.remove("key" + std::to_string(i));
+    }
+    EXPECT_FALSE(dict.isLarge());
+    EXPECT_EQ(dict.count(), 3);
+    EXPECT_EQ(dict.get("a"), 10);
+    EXPECT_THROW(dict.remove("missing"), std::runtime_error);
+
+    dict.clear();
+    EXPECT_EQ(dict.count(), 0);
+    EXPECT_EQ(dict.capacity(), 0);
+}
+
+// Тест поиска без исключений в словаре и кэшах
+TEST(Dictionary, Find) {
+    Dictionary<std::string, int> dict;
+    dict.add("one", 1);
+    dict.add("two", 2);
+    ASSERT_NE(dict.find("one"), nullptr);
+    EXPECT_EQ(*dict.find("one"), 1);
+    *dict.find("two") = 22;
+    EXPECT_EQ(dict.get("two"), 22);
+    EXPECT_EQ(dict.find("three"), nullptr);
+    const Dictionary<std::string, int>& constDict = dict;
+    EXPECT_EQ(*constDict.find("one"), 1);
+}
+
+TEST(LRUCache, FindAndTryGet) {
+    LRUCache<int, std::string> cache(2);
+    cache.access(1, "one");
+    cache.access(2, "two");
+    ASSERT_NE(cache.find(1), nullptr); // find помечает 1 как использованный
+    cache.access(3, "three");
+    EXPECT_EQ(cache.find(2), nullptr);
+    std::string value;
+    EXPECT_TRUE(cache.try_get(1, value));
+    EXPECT_EQ(value, "one");
+    EXPECT_FALSE(cache.try_get(2, value));
+
+    ShardedLRUCache<int, std::string> sharded(4, 2);
+    sharded.access(1, "one");
+    EXPECT_TRUE(sharded.try_get(1, value));
+    EXPECT_EQ(value, "one");
+    EXPECT_FALSE(sharded.try_get(5, value));
+    EXPECT_EQ(sharded.find(5), nullptr);
+}
+
+// Управляемые часы для тестов TTL: время идёт только по команде
+LRUCache<int, std::string>::TimePoint fakeNow = LRUCache<int, std::string>::Clock::now();
+
+LRUCache<int, std::string>::TimePoint fakeClock() {
+    return fakeNow;
+}
+
+// Тест ленивого удаления просроченных элементов
+TEST(LRUCache, TtlLazyExpiration) {
+    LRUCache<int, std::string> cache(10);
+    cache.setClock(&fakeClock);
+    cache.access(1, "short", std::chrono::milliseconds(20));
+    cache.access(2, "forever");
+    cache.setDefaultTtl(std::chrono::hours(1));
+    cache.access(3, "long");
+    fakeNow += std::chrono::milliseconds(19);
+    EXPECT_TRUE(cache.contains(1));
+
+    fakeNow += std::chrono::milliseconds(1);
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_EQ(cache.find(1), nullptr);
+    EXPECT_THROW(cache.get(1), std::runtime_error);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.get(2), "forever");
+    EXPECT_EQ(cache.get(3), "long");
+}
+
+// Тест сборщика: просроченные элементы удаляются без обращений к ним
+TEST(LRUCache, TtlReaper) {
+    LRUCache<int, std::string> cache(100);
+    cache.setClock(&fakeClock);
+    cache.enableReaper(std::chrono::milliseconds(5), 64);
+    for (int i = 0; i < 50; i++) {
+        cache.access(i, "value", std::chrono::milliseconds(10));
+    }
+    cache.access(100, "stays");
+    cache.access(0, "refreshed", std::chrono::hours(1)); // Таймер ключа 0 перенесётся при срабатывании
+    EXPECT_EQ(cache.timerCount(), 50);
+    fakeNow += std::chrono::milliseconds(40);
+    EXPECT_EQ(cache.reapExpired(), 49);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.get(0), "refreshed");
+    EXPECT_EQ(cache.timerCount(), 1);
+
+    // Частое продление срока не плодит таймеры: у элемента один таймер, который переносится
+    for (int i = 0; i < 1000; i++) {
+        cache.access(7, "hot", std::chrono::milliseconds(100));
+        fakeNow += std::chrono::milliseconds(1);
+        cache.reapExpired();
+    }
+    EXPECT_EQ(cache.timerCount(), 2);
+    EXPECT_TRUE(cache.contains(7));
+    fakeNow += std::chrono::milliseconds(100);
+    EXPECT_EQ(cache.reapExpired(), 1);
+    EXPECT_FALSE(cache.contains(7));
+
+    ShardedLRUCache<int, std::string> sharded(100, 4);
+    sharded.startReaper(std::chrono::milliseconds(5));
+    for (int i = 0; i < 20; i++) {
+        sharded.access(i, "value", std::chrono::milliseconds(10));
+    }
+    // Фоновый поток работает по настоящим часам: ждём с большим запасом, а не фиксированную паузу
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (sharded.size() != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(sharded.size(), 0);
+    sharded.stopReaper();
+}
+
+// Тест счётчиков статистики
+TEST(LRUCache, Stats) {
+    LRUCache<int, std::string, DefaultWeigher<std::string>, AtomicStats> cache(2);
+    cache.access(1, "one");
+    cache.access(2, "two");
+    cache.access(1, "uno"); // Обновление, а не новая вставка
+    cache.access(3, "three"); // Вытесняет 2
+    EXPECT_NE(cache.find(1), nullptr);
+    EXPECT_EQ(cache.find(2), nullptr);
+    EXPECT_THROW(cache.get(4), std::runtime_error);
+
+    CacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.insertions, 3);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.bytesResident, 8);
+    EXPECT_DOUBLE_EQ(stats.hitRate(), 1.0 / 3.0);
+    EXPECT_EQ(stats.getLatency.count(), 3);
+    EXPECT_EQ(stats.accessLatency.count(), 4);
+    EXPECT_LE(stats.getLatency.percentile(0.5), stats.getLatency.percentile(0.99));
+
+    // Без политики статистики счётчики не ведутся
+    LRUCache<int, std::string> plain(2);
+    plain.access(1, "one");
+    plain.find(1);
+    EXPECT_EQ(plain.stats().hits, 0);
+    EXPECT_EQ(plain.stats().bytesResident, 3);
+
+    ShardedLRUCache<int, std::string, AtomicStats> sharded(10, 2);
+    sharded.access(1, "one");
+    sharded.find(1);
+    sharded.find(2);
+    EXPECT_EQ(sharded.stats().hits, 1);
+    EXPECT_EQ(sharded.stats().misses, 1);
+}
+
+TEST(LatencyHistogram, Percentile) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 99; i++) {
+        histogram.buckets[LatencyHistogram::bucketOf(100)]++; // [64, 128)
+    }
+    histogram.buckets[LatencyHistogram::bucketOf(100000)]++; // [65536, 131072)
+    EXPECT_EQ(histogram.percentile(0.5), 128);
+    EXPECT_EQ(histogram.percentile(0.999), 131072);
+}
+
+// Одновременные промахи по одному ключу должны вызывать загрузчик один раз
+TEST(LoadingCache, CoalescesConcurrentMisses) {
+    LRUCache<int, int> backing(10);
+    std::atomic<int> loads{0};
+    LoadingCache<int, int> cache(backing, [&loads](const int& key) {
+        loads++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return key * 10;
+    });
+
+    std::vector<std::thread> threads;
+    std::atomic<int> sum{0};
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&cache, &sum]() { sum += cache.get(7); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(loads, 1);
+    EXPECT_EQ(sum, 8 * 70);
+    EXPECT_EQ(cache.get(7), 70);
+    EXPECT_EQ(loads, 1);
+    EXPECT_EQ(cache.loading(), 0);
+}
+
+TEST(LoadingCache, AsyncAndErrors) {
+    LRUCache<int, int> backing(10);
+    std::atomic<int> loads{0};
+    LoadingCache<int, int> cache(backing, [&loads](const int& key) {
+        loads++;
+        if (key < 0) {
+            throw std::runtime_error("Negative key");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return key + 1;
+    });
+
+    std::shared_future<int> first = cache.get_async(1);
+    std::shared_future<int> second = cache.get_async(1);
+    EXPECT_EQ(first.get(), 2);
+    EXPECT_EQ(second.get(), 2);
+    EXPECT_EQ(loads, 1);
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_EQ(cache.get_async(1).get(), 2); // Попадание - готовый future
+
+    EXPECT_THROW(cache.get(-1), std::runtime_error);
+    EXPECT_THROW(cache.get_async(-1).get(), std::runtime_error);
+    EXPECT_FALSE(cache.contains(-1));
+    EXPECT_EQ(loads, 3); // Ошибка не кэшируется: каждый промах загружает заново
+}
+
+// Фоновые загрузки ограничены пулом, попадания в потокобезопасный кэш идут без общего мьютекса
+TEST(LoadingCache, BoundedAsyncAndConcurrentHits) {
+    ShardedLRUCache<int, int> backing(1000, 4);
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    LoadingCache<int, int> cache(backing, [&running, &peak](const int& key) {
+        int now = ++running;
+        int seen = peak;
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --running;
+        return key * 2;
+    }, 2);
+
+    std::vector<std::shared_future<int>> futures;
+    for (int i = 0; i < 40; i++) {
+        futures.push_back(cache.get_async(i));
+    }
+    for (int i = 0; i < 40; i++) {
+        EXPECT_EQ(futures[i].get(), i * 2);
+    }
+    EXPECT_LE(peak, 2);
+    EXPECT_EQ(cache.size(), 40);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&cache]() {
+            for (int i = 0; i < 2000; i++) {
+                EXPECT_EQ(cache.get(i % 40), (i % 40) * 2);
+            }
+        });
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(cache.loading(), 0);
+}
+
+TEST(ConcurrentDictionary, BasicOperations) {
+    ConcurrentDictionary<std::string, int> dict(5);
+    EXPECT_EQ(dict.stripeCount(), 8);
+    dict.add("one", 1);
+    dict.add("two", 2);
+    EXPECT_TRUE(dict.contains_key("one"));
+    EXPECT_EQ(dict.get_copy("two"), 2);
+    EXPECT_FALSE(dict.add_if_absent("one", 100));
+    EXPECT_TRUE(dict.update("one", [](int& value) { value += 10; }));
+    EXPECT_EQ(dict.get_copy("one"), 11);
+    dict.remove("one");
+    EXPECT_FALSE(dict.contains_key("one"));
+    EXPECT_THROW(dict.get_copy("one"), std::runtime_error);
+    EXPECT_THROW((ConcurrentDictionary<int, int>(0)), std::invalid_argument);
+
+    // Хэш задаётся параметром: seeded для недоверенных ключей, сторонний без is_avalanching тоже работает
+    ConcurrentDictionary<std::string, int> seeded(16, DefaultHash<std::string>::seeded());
+    ConcurrentDictionary<int, int, std::hash<int>> identity(16);
+    for (int i = 0; i < 1000; i++) {
+        seeded.add("file" + std::to_string(i), i);
+        identity.add(i * 1024, i);
+    }
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(seeded.get_copy("file" + std::to_string(i)), i);
+        ASSERT_EQ(identity.get_copy(i * 1024), i);
+    }
+    EXPECT_EQ(seeded.count(), 1000);
+}
+
+// Читатели без блокировок не видят разрушенных значений, пока писатели заменяют, удаляют
+// и снова добавляют ключи (с расширениями полос), а заменённые узлы потом освобождаются
+TEST(ConcurrentDictionary, LockFreeReadsDuringChurn) {
+    ConcurrentDictionary<int, std::string> dict(2);
+    for (int i = 0; i < 64; i++) {
+        dict.add(i, std::string(32, 'a' + i % 26));
+    }
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&]() {
+            std::string value;
+            while (!done) {
+                for (int i = 0; i < 64; i++) {
+                    if (dict.try_get(i, value)) {
+                        ASSERT_EQ(value.size(), 32u);
+                        ASSERT_EQ(value, std::string(32, value[0]));
+                    }
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < 64; i++) {
+            if (round % 3 == 0) {
+                dict.remove(i);
+                dict.add(i, std::string(32, 'A' + round % 26));
+            } else {
+                dict.update(i, [round](std::string& value) { value.assign(32, 'a' + round % 26); });
+            }
+        }
+        for (int i = 64; i < 64 + round; i++) { // Полосы растут во время чтения
+            dict.add_if_absent(i, std::string(32, 'z'));
+        }
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(dict.count(), 64u + 199u);
+    reclamation::reclaim(); // Без читателей всё исключённое освобождается
+    EXPECT_EQ(reclamation::pending(), 0u);
+}
+
+// Параллельные писатели и читатели на общем словаре
+TEST(ConcurrentDictionary, ConcurrentReadersAndWriters) {
+    ConcurrentDictionary<int, int> dict;
+    const int writers = 4;
+    const int perWriter = 5000;
+    std::atomic<bool> done{false};
+    std::atomic<long> misses{0};
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; w++) {
+        threads.emplace_back([&dict, w]() {
+            for (int i = 0; i < perWriter; i++) {
+                dict.add(w * perWriter + i, i);
+            }
+        });
+    }
+    for (int r = 0; r < 4; r++) {
+        threads.emplace_back([&]() {
+            while (!done) {
+                for (int key = 0; key < writers * perWriter; key += 97) {
+                    int value;
+                    if (dict.try_get(key, value)) {
+                        EXPECT_EQ(value, key % perWriter);
+                    } else {
+                        misses++;
+                    }
+                }
+            }
+        });
+    }
+    for (int w = 0; w < writers; w++) {
+        threads[w].join();
+    }
+    done = true;
+    for (size_t i = writers; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    EXPECT_EQ(dict.count(), static_cast<size_t>(writers * perWriter));
+    long sum = 0;
+    dict.for_each([&sum](const int&, const int& value) { sum += value; });
+    EXPECT_EQ(sum, static_cast<long>(writers) * perWriter * (perWriter - 1) / 2);
+}